@@ -192,6 +192,34 @@ namespace fs
 		// Do notning
 	}
 
+	u64 file_base::read_at(u64 offset, void* buffer, u64 size)
+	{
+		const u64 old_pos = seek(0, seek_cur);
+
+		if (seek(offset, seek_set) != offset)
+		{
+			return 0;
+		}
+
+		const u64 result = read(buffer, size);
+		seek(old_pos, seek_set);
+		return result;
+	}
+
+	u64 file_base::write_at(u64 offset, const void* buffer, u64 size)
+	{
+		const u64 old_pos = seek(0, seek_cur);
+
+		if (seek(offset, seek_set) != offset)
+		{
+			return 0;
+		}
+
+		const u64 result = write(buffer, size);
+		seek(old_pos, seek_set);
+		return result;
+	}
+
 	dir_base::~dir_base()
 	{
 	}
@@ -959,6 +987,42 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 			return nwritten;
 		}
 
+		u64 read_at(u64 offset, void* buffer, u64 count) override
+		{
+			// TODO (call ReadFile multiple times if count is too big)
+			const int size = narrow<int>(count, "file::read_at" HERE);
+
+			// Synchronous handle: the offset is taken from OVERLAPPED (file pointer is updated)
+			OVERLAPPED ovl{};
+			ovl.Offset = static_cast<DWORD>(offset);
+			ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD nread;
+
+			if (!ReadFile(m_handle, buffer, size, &nread, &ovl))
+			{
+				verify("file::read_at" HERE), GetLastError() == ERROR_HANDLE_EOF;
+				return 0;
+			}
+
+			return nread;
+		}
+
+		u64 write_at(u64 offset, const void* buffer, u64 count) override
+		{
+			// TODO (call WriteFile multiple times if count is too big)
+			const int size = narrow<int>(count, "file::write_at" HERE);
+
+			OVERLAPPED ovl{};
+			ovl.Offset = static_cast<DWORD>(offset);
+			ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD nwritten;
+			verify("file::write_at" HERE), WriteFile(m_handle, buffer, size, &nwritten, &ovl);
+
+			return nwritten;
+		}
+
 		u64 seek(s64 offset, seek_mode whence) override
 		{
 			LARGE_INTEGER pos;
@@ -1100,6 +1164,22 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 			return result;
 		}
 
+		u64 read_at(u64 offset, void* buffer, u64 count) override
+		{
+			const auto result = ::pread(m_fd, buffer, count, offset);
+			verify("file::read_at" HERE), result != -1;
+
+			return result;
+		}
+
+		u64 write_at(u64 offset, const void* buffer, u64 count) override
+		{
+			const auto result = ::pwrite(m_fd, buffer, count, offset);
+			verify("file::write_at" HERE), result != -1;
+
+			return result;
+		}
+
 		u64 seek(s64 offset, seek_mode whence) override
 		{
 			const int mode =
@@ -1220,6 +1300,76 @@ fs::native_handle fs::file::get_handle() const
 #endif
 }
 
+fs::file_view::file_view(const fs::file& f)
+{
+	if (!f)
+	{
+		return;
+	}
+
+	const u64 size = f.size();
+
+	if (!size || size != static_cast<std::size_t>(size))
+	{
+		return;
+	}
+
+	const auto handle = f.get_handle();
+
+#ifdef _WIN32
+	if (handle != INVALID_HANDLE_VALUE)
+	{
+		if (const HANDLE mapping = CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, 0, NULL))
+		{
+			m_ptr = static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size));
+			CloseHandle(mapping);
+		}
+	}
+#else
+	if (handle != -1)
+	{
+		const auto ptr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, handle, 0);
+
+		if (ptr != MAP_FAILED)
+		{
+			m_ptr = static_cast<const u8*>(ptr);
+		}
+	}
+#endif
+
+	if (!m_ptr)
+	{
+		// Fallback to reading the whole file
+		m_copy = std::make_unique<u8[]>(size);
+
+		if (f.seek(0), f.read(m_copy.get(), size) != size)
+		{
+			m_copy.reset();
+			return;
+		}
+
+		m_ptr = m_copy.get();
+	}
+
+	m_size = size;
+}
+
+void fs::file_view::close()
+{
+	if (m_ptr && !m_copy)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_ptr);
+#else
+		::munmap(const_cast<u8*>(m_ptr), m_size);
+#endif
+	}
+
+	m_copy.reset();
+	m_ptr = nullptr;
+	m_size = 0;
+}
+
 void fs::dir::xnull() const
 {
 	fmt::throw_exception<std::logic_error>("fs::dir is null");
@@ -83,6 +83,10 @@ namespace fs
 		virtual u64 write(const void* buffer, u64 size) = 0;
 		virtual u64 seek(s64 offset, seek_mode whence) = 0;
 		virtual u64 size() = 0;
+
+		// Positional I/O (default implementation temporarily changes the position)
+		virtual u64 read_at(u64 offset, void* buffer, u64 size);
+		virtual u64 write_at(u64 offset, const void* buffer, u64 size);
 	};
 
 	// Directory entry (TODO)
@@ -257,6 +261,20 @@ namespace fs
 			return m_file->write(buffer, count);
 		}
 
+		// Read the data at the specified offset (the current position is not used and may change)
+		u64 read_at(u64 offset, void* buffer, u64 count) const
+		{
+			if (!m_file) xnull();
+			return m_file->read_at(offset, buffer, count);
+		}
+
+		// Write the data at the specified offset (the current position is not used and may change)
+		u64 write_at(u64 offset, const void* buffer, u64 count) const
+		{
+			if (!m_file) xnull();
+			return m_file->write_at(offset, buffer, count);
+		}
+
 		// Change current position, returns resulting position
 		u64 seek(s64 offset, seek_mode whence = seek_set) const
 		{
@@ -368,6 +386,74 @@ namespace fs
 		native_handle get_handle() const;
 	};
 
+	// Read-only view of the whole file contents (memory-mapped if possible, copied otherwise)
+	class file_view final
+	{
+		const u8* m_ptr = nullptr;
+		u64 m_size = 0;
+
+		// Heap copy used when the file can't be mapped
+		std::unique_ptr<u8[]> m_copy;
+
+	public:
+		file_view() = default;
+
+		// Map current contents of the file (size is fixed at this point)
+		explicit file_view(const file& f);
+
+		file_view(const file_view&) = delete;
+
+		file_view& operator=(const file_view&) = delete;
+
+		file_view(file_view&& r)
+			: m_ptr(r.m_ptr)
+			, m_size(r.m_size)
+			, m_copy(std::move(r.m_copy))
+		{
+			r.m_ptr = nullptr;
+			r.m_size = 0;
+		}
+
+		file_view& operator=(file_view&& r)
+		{
+			if (this != &r)
+			{
+				close();
+				m_ptr = r.m_ptr;
+				m_size = r.m_size;
+				m_copy = std::move(r.m_copy);
+				r.m_ptr = nullptr;
+				r.m_size = 0;
+			}
+
+			return *this;
+		}
+
+		~file_view()
+		{
+			close();
+		}
+
+		// Check whether the view is valid (empty files can't be mapped)
+		explicit operator bool() const
+		{
+			return m_ptr != nullptr;
+		}
+
+		// Unmap the view explicitly
+		void close();
+
+		const u8* data() const
+		{
+			return m_ptr;
+		}
+
+		u64 size() const
+		{
+			return m_size;
+		}
+	};
+
 	class dir final
 	{
 		std::unique_ptr<dir_base> m_dir;
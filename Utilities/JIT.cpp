@@ -7,6 +7,7 @@
 #include "sysinfo.h"
 #include "VirtualMemory.h"
 #include <immintrin.h>
+#include <zlib.h>
 
 // Memory manager mutex
 shared_mutex s_mutex2;
@@ -485,12 +486,30 @@ struct MemoryManager : llvm::RTDyldMemoryManager
 // Simple memory manager
 struct MemoryManager2 : llvm::RTDyldMemoryManager
 {
-	MemoryManager2() = default;
+	const std::function<u64(const std::string&)>& m_resolver;
+
+	MemoryManager2(const std::function<u64(const std::string&)>& resolver)
+		: m_resolver(resolver)
+	{
+	}
 
 	~MemoryManager2() override
 	{
 	}
 
+	llvm::JITSymbol findSymbol(const std::string& name) override
+	{
+		if (m_resolver)
+		{
+			if (const u64 addr = m_resolver(name))
+			{
+				return {addr, llvm::JITSymbolFlags::Exported};
+			}
+		}
+
+		return RTDyldMemoryManager::findSymbol(name);
+	}
+
 	u8* allocateCodeSection(std::uintptr_t size, uint align, uint sec_id, llvm::StringRef sec_name) override
 	{
 		return jit_runtime::alloc(size, align, true);
@@ -617,6 +636,15 @@ struct EventListener : llvm::JITEventListener
 	}
 };
 
+// Compressed object file header (followed by zlib stream), uncompressed object files are also supported
+struct zobj_header
+{
+	u64 magic; // "RPCS3ZOB"
+	u64 size; // Uncompressed size
+};
+
+static constexpr u64 s_zobj_magic = 0x424f5a3353435052;
+
 // Helper class
 class ObjectCache final : public llvm::ObjectCache
 {
@@ -634,20 +662,114 @@ public:
 	{
 		std::string name = m_path;
 		name.append(module->getName());
-		fs::file(name, fs::rewrite).write(obj.getBufferStart(), obj.getBufferSize());
+
+		// Compress object
+		std::vector<u8> zbuf(sizeof(zobj_header) + ::compressBound(static_cast<uLong>(obj.getBufferSize())));
+		uLongf zsize = static_cast<uLongf>(zbuf.size() - sizeof(zobj_header));
+
+		const void* data = obj.getBufferStart();
+		std::size_t size = obj.getBufferSize();
+
+		if (::compress2(zbuf.data() + sizeof(zobj_header), &zsize, reinterpret_cast<const Bytef*>(data), static_cast<uLong>(size), Z_BEST_SPEED) == Z_OK)
+		{
+			zobj_header header;
+			header.magic = s_zobj_magic;
+			header.size = size;
+			std::memcpy(zbuf.data(), &header, sizeof(header));
+
+			data = zbuf.data();
+			size = sizeof(zobj_header) + zsize;
+		}
+		else
+		{
+			LOG_ERROR(GENERAL, "LLVM: Failed to compress module: %s", name);
+		}
+
+		// Write to the temporary file first, so an interrupted write never leaves a broken object
+		const std::string tmp = name + ".tmp";
+
+		fs::file out(tmp, fs::rewrite);
+
+		if (!out || out.write(data, size) != size)
+		{
+			LOG_ERROR(GENERAL, "LLVM: Failed to write module: %s (%s)", tmp, fs::g_tls_error);
+			out.close();
+			fs::remove_file(tmp);
+			return;
+		}
+
+		out.close();
+
+		if (!fs::rename(tmp, name, true))
+		{
+			LOG_ERROR(GENERAL, "LLVM: Failed to rename module: %s (%s)", name, fs::g_tls_error);
+			fs::remove_file(tmp);
+			return;
+		}
+
 		LOG_NOTICE(GENERAL, "LLVM: Created module: %s", module->getName().data());
 	}
 
 	static std::unique_ptr<llvm::MemoryBuffer> load(const std::string& path)
 	{
-		if (fs::file cached{path, fs::read})
+		fs::file cached{path, fs::read};
+
+		if (!cached)
 		{
-			auto buf = llvm::WritableMemoryBuffer::getNewUninitMemBuffer(cached.size());
-			cached.read(buf->getBufferStart(), buf->getBufferSize());
-			return buf;
+			return nullptr;
 		}
 
-		return nullptr;
+		zobj_header header{};
+
+		if (!cached.read(header) || header.magic != s_zobj_magic)
+		{
+			cached.close();
+
+			// Uncompressed object: map the file (no null terminator required for memory mapping)
+			auto mapped = llvm::MemoryBuffer::getFile(path, -1, false);
+
+			if (!mapped)
+			{
+				LOG_ERROR(GENERAL, "LLVM: Failed to map module: %s (%s)", path, mapped.getError().message());
+				return nullptr;
+			}
+
+			return std::move(mapped.get());
+		}
+
+		// Compressed object: decompress directly from the mapped file
+		const fs::file_view view(cached);
+
+		if (!view || view.size() < sizeof(zobj_header))
+		{
+			LOG_ERROR(GENERAL, "LLVM: Failed to read module: %s", path);
+			return nullptr;
+		}
+
+		// Deflate can't compress better than ~1032:1, reject damaged headers before allocating (module is recompiled)
+		if (header.size == 0 || header.size > (view.size() - sizeof(zobj_header)) * 1032 || header.size > UINT32_MAX)
+		{
+			LOG_ERROR(GENERAL, "LLVM: Invalid module size: %s (0x%llx)", path, header.size);
+			return nullptr;
+		}
+
+		auto buf = llvm::WritableMemoryBuffer::getNewUninitMemBuffer(header.size);
+
+		if (!buf)
+		{
+			LOG_ERROR(GENERAL, "LLVM: Failed to allocate module: %s (0x%llx)", path, header.size);
+			return nullptr;
+		}
+
+		uLongf size = static_cast<uLongf>(header.size);
+
+		if (::uncompress(reinterpret_cast<Bytef*>(buf->getBufferStart()), &size, view.data() + sizeof(zobj_header), static_cast<uLong>(view.size() - sizeof(zobj_header))) != Z_OK || size != header.size)
+		{
+			LOG_ERROR(GENERAL, "LLVM: Failed to decompress module: %s", path);
+			return nullptr;
+		}
+
+		return buf;
 	}
 
 	std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* module) override
@@ -726,7 +848,7 @@ jit_compiler::jit_compiler(const std::unordered_map<std::string, u64>& _link, co
 		}
 		else
 		{
-			mem = std::make_unique<MemoryManager2>();
+			mem = std::make_unique<MemoryManager2>(m_resolver);
 		}
 
 		// Auxiliary JIT (does not use custom memory manager, only writes the objects)
@@ -819,9 +941,45 @@ void jit_compiler::add(std::unique_ptr<llvm::Module> module)
 	}
 }
 
-void jit_compiler::add(const std::string& path)
+bool jit_compiler::add(const std::string& path)
+{
+	auto cache = ObjectCache::load(path);
+
+	if (!cache)
+	{
+		return false;
+	}
+
+	auto object_file = llvm::object::ObjectFile::createObjectFile(*cache);
+
+	if (!object_file)
+	{
+		LOG_ERROR(GENERAL, "LLVM: Invalid object file: %s (%s)", path, llvm::toString(object_file.takeError()));
+		return false;
+	}
+
+	m_engine->addObjectFile(std::move(*object_file));
+	return true;
+}
+
+bool jit_compiler::check(const std::string& path)
 {
-	m_engine->addObjectFile(std::move(llvm::object::ObjectFile::createObjectFile(*ObjectCache::load(path)).get()));
+	const auto cache = ObjectCache::load(path);
+
+	if (!cache)
+	{
+		return false;
+	}
+
+	auto object_file = llvm::object::ObjectFile::createObjectFile(*cache);
+
+	if (!object_file)
+	{
+		LOG_ERROR(GENERAL, "LLVM: Invalid object file: %s (%s)", path, llvm::toString(object_file.takeError()));
+		return false;
+	}
+
+	return true;
 }
 
 void jit_compiler::fin()
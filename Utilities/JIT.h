@@ -124,6 +124,9 @@ class jit_compiler final
 	// Link table
 	std::unordered_map<std::string, u64> m_link;
 
+	// External symbol resolver (auxiliary JIT only)
+	std::function<u64(const std::string&)> m_resolver;
+
 	// Arch
 	std::string m_cpu;
 
@@ -151,8 +154,17 @@ public:
 	// Add module (not cached)
 	void add(std::unique_ptr<llvm::Module> module);
 
-	// Add object (path to obj file)
-	void add(const std::string& path);
+	// Add object (path to obj file), returns false if the file is missing or invalid
+	bool add(const std::string& path);
+
+	// Check that the object file can be loaded (without adding it)
+	static bool check(const std::string& path);
+
+	// Set external symbol resolver (auxiliary JIT only, must be set before adding modules)
+	void set_resolver(std::function<u64(const std::string&)> resolver)
+	{
+		m_resolver = std::move(resolver);
+	}
 
 	// Finalize
 	void fin();
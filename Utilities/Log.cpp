@@ -13,6 +13,7 @@
 #include <thread>
 #include <chrono>
 #include <cstring>
+#include <algorithm>
 
 using namespace std::literals::chrono_literals;
 
@@ -61,6 +62,22 @@ namespace logs
 	// Memory-mapped buffer size
 	constexpr u64 s_log_size = 32 * 1024 * 1024;
 
+	// First byte of a binary record (replaced in text messages)
+	constexpr char s_record_marker = '\xff';
+
+	// Message stored without formatting (followed by arguments and prefix)
+	struct binary_record
+	{
+		char marker;
+		u8 argc;
+		u16 prefix_size;
+		u32 size; // Full record size
+		u64 stamp;
+		const message* msg;
+		const char* fmt;
+		const fmt_type_info* sup;
+	};
+
 	class file_writer
 	{
 		fs::file m_file;
@@ -82,6 +99,18 @@ namespace logs
 
 		uchar m_zout[65536];
 
+		// Text of the buffer fragment with formatted binary records
+		std::string m_text;
+		std::vector<u64> m_args;
+		std::string m_prefix;
+		std::string m_body;
+
+		// Copy data from the buffer
+		void read(u64 pos, void* dst, u64 size) const;
+
+		// Format binary records in the buffer fragment (fills m_text, returns the amount of bytes processed)
+		u64 decode(u64 pos, u64 size);
+
 		// Write buffered logs immediately
 		bool flush(u64 bufv);
 
@@ -127,6 +156,9 @@ namespace logs
 		// Encode level, current thread name, channel name and write log message
 		virtual void log(u64 stamp, const message& msg, const std::string& prefix, const std::string& text) override;
 
+		// Write log message arguments without formatting
+		void log_deferred(u64 stamp, const message& msg, const std::string& prefix, const char* fmt, const fmt_type_info* sup, const u64* args);
+
 		// Channel registry
 		std::unordered_map<std::string, channel_info> channels;
 
@@ -188,6 +220,9 @@ namespace logs
 	// Must be set to true in main()
 	atomic_t<bool> g_init{false};
 
+	// Format messages with plain arguments on the writer thread
+	atomic_t<bool> g_deferred{false};
+
 	void reset()
 	{
 		std::lock_guard lock(g_mutex);
@@ -205,6 +240,11 @@ namespace logs
 		get_logger()->channels[ch_name].set_level(value);
 	}
 
+	void set_deferred(bool value)
+	{
+		g_deferred = value;
+	}
+
 	// Must be called in main() to stop accumulating messages in g_messages
 	void set_init()
 	{
@@ -221,6 +261,11 @@ logs::listener::~listener()
 {
 }
 
+bool logs::listener::is_enabled(logs::level) const
+{
+	return true;
+}
+
 void logs::listener::add(logs::listener* _new)
 {
 	// Get first (main) listener
@@ -241,7 +286,44 @@ void logs::listener::add(logs::listener* _new)
 	}
 }
 
+// Extract va_args (the amount is determined by the type list)
+static const u64* get_args(const fmt_type_info* sup, std::va_list c_args)
+{
+	thread_local std::vector<u64> args;
+
+	std::size_t args_count = 0;
+	for (auto v = sup; v->fmt_string; v++)
+		args_count++;
+
+	args.resize(args_count);
+
+	for (u64& arg : args)
+		arg = va_arg(c_args, u64);
+
+	return args.data();
+}
+
 void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, ...) const
+{
+	std::va_list c_args;
+	va_start(c_args, sup);
+	const u64* args = get_args(sup, c_args);
+	va_end(c_args);
+
+	dispatch(fmt, sup, args, false);
+}
+
+void logs::message::broadcast_deferred(const char* fmt, const fmt_type_info* sup, ...) const
+{
+	std::va_list c_args;
+	va_start(c_args, sup);
+	const u64* args = get_args(sup, c_args);
+	va_end(c_args);
+
+	dispatch(fmt, sup, args, true);
+}
+
+void logs::message::dispatch(const char* fmt, const fmt_type_info* sup, const u64* args, bool deferrable) const
 {
 	// Get timestamp
 	const u64 stamp = get_stamp();
@@ -270,28 +352,41 @@ void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, ...) co
 		}
 	}
 
-	// Get text, extract va_args
 	thread_local std::string text;
-	thread_local std::vector<u64> args;
-
-	std::size_t args_count = 0;
-	for (auto v = sup; v->fmt_string; v++)
-		args_count++;
-
-	text.clear();
-	args.resize(args_count);
 
-	va_list c_args;
-	va_start(c_args, sup);
-	for (u64& arg : args)
-		arg = va_arg(c_args, u64);
-	va_end(c_args);
-	fmt::raw_append(text, fmt, sup, args.data());
 	std::string prefix = g_tls_log_prefix();
 
 	// Get first (main) listener
 	listener* lis = get_logger();
 
+	if (deferrable && g_deferred && g_init)
+	{
+		get_logger()->log_deferred(stamp, *this, prefix, fmt, sup, args);
+
+		// Format text only if other listeners need it
+		bool formatted = false;
+
+		for (lis = lis->m_next; lis; lis = lis->m_next)
+		{
+			if (lis->is_enabled(sev))
+			{
+				if (!formatted)
+				{
+					text.clear();
+					fmt::raw_append(text, fmt, sup, args);
+					formatted = true;
+				}
+
+				lis->log(stamp, *this, prefix, text);
+			}
+		}
+
+		return;
+	}
+
+	text.clear();
+	fmt::raw_append(text, fmt, sup, args);
+
 	if (!g_init)
 	{
 		std::lock_guard lock(g_mutex);
@@ -317,6 +412,56 @@ void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, ...) co
 	}
 }
 
+// Encode level, timestamp, thread name, channel name and append log message line
+static void format_line(std::string& out, u64 stamp, const logs::message& msg, const std::string& prefix, const std::string& text)
+{
+	const std::size_t start = out.size();
+
+	// Used character: U+00B7 (Middle Dot)
+	switch (msg.sev)
+	{
+	case logs::level::always:  out += u8"·A "; break;
+	case logs::level::fatal:   out += u8"·F "; break;
+	case logs::level::error:   out += u8"·E "; break;
+	case logs::level::todo:    out += u8"·U "; break;
+	case logs::level::success: out += u8"·S "; break;
+	case logs::level::warning: out += u8"·W "; break;
+	case logs::level::notice:  out += u8"·! "; break;
+	case logs::level::trace:   out += u8"·T "; break;
+	case logs::level::_uninit: out += u8"·  "; break;
+	}
+
+	// Print µs timestamp
+	const u64 hours = stamp / 3600'000'000;
+	const u64 mins = (stamp % 3600'000'000) / 60'000'000;
+	const u64 secs = (stamp % 60'000'000) / 1'000'000;
+	const u64 frac = (stamp % 1'000'000);
+	fmt::append(out, "%u:%02u:%02u.%06u ", hours, mins, secs, frac);
+
+	if (prefix.size() > 0)
+	{
+		out += "{";
+		out += prefix;
+		out += "} ";
+	}
+
+	if (msg.ch && '\0' != *msg.ch->name)
+	{
+		out += msg.ch->name;
+		out += msg.sev == logs::level::todo ? " TODO: " : ": ";
+	}
+	else if (msg.sev == logs::level::todo)
+	{
+		out += "TODO: ";
+	}
+
+	out += text;
+	out += '\n';
+
+	// Binary records are recognized by the first byte of a line (invalid UTF-8)
+	std::replace(out.begin() + start, out.end(), logs::s_record_marker, '?');
+}
+
 [[noreturn]] extern void catch_all_exceptions();
 
 logs::file_writer::file_writer(const std::string& name)
@@ -482,6 +627,53 @@ logs::file_writer::~file_writer()
 #endif
 }
 
+void logs::file_writer::read(u64 pos, void* dst, u64 size) const
+{
+	const u64 off  = pos % s_log_size;
+	const u64 frag = std::min<u64>(size, s_log_size - off);
+	std::memcpy(dst, m_fptr + off, frag);
+	std::memcpy(static_cast<uchar*>(dst) + frag, m_fptr, size - frag);
+}
+
+u64 logs::file_writer::decode(u64 pos, u64 size)
+{
+	m_text.clear();
+
+	const u64 st = pos;
+
+	while (pos < st + size)
+	{
+		const uchar* ptr = m_fptr + pos % s_log_size;
+
+		binary_record rec;
+
+		if (*ptr != static_cast<uchar>(s_record_marker) || (read(pos, &rec, sizeof(rec)), rec.size < sizeof(rec)))
+		{
+			// Copy text until the end of line (fragment never wraps around)
+			const u64 avail = st + size - pos;
+			const auto eol  = static_cast<const uchar*>(std::memchr(ptr, '\n', avail));
+			const u64 count = eol ? eol - ptr + 1 : avail;
+			m_text.append(reinterpret_cast<const char*>(ptr), count);
+			pos += count;
+			continue;
+		}
+
+		// Record is complete, but may extend past the fragment or wrap around
+		m_args.resize(rec.argc);
+		read(pos + sizeof(rec), m_args.data(), rec.argc * sizeof(u64));
+
+		m_prefix.resize(rec.prefix_size);
+		read(pos + sizeof(rec) + rec.argc * sizeof(u64), &m_prefix[0], rec.prefix_size);
+
+		m_body.clear();
+		fmt::raw_append(m_body, rec.fmt, rec.sup, m_args.data());
+		format_line(m_text, rec.stamp, *rec.msg, m_prefix, m_body);
+		pos += rec.size;
+	}
+
+	return pos - st;
+}
+
 bool logs::file_writer::flush(u64 bufv)
 {
 	std::lock_guard lock(m_m);
@@ -492,10 +684,21 @@ bool logs::file_writer::flush(u64 bufv)
 	if (end > st)
 	{
 		// Avoid writing too big fragments
-		const u64 size = std::min<u64>(end - st, sizeof(m_zout) / 2);
+		u64 size = std::min<u64>(end - st, sizeof(m_zout) / 2);
+
+		const uchar* data = m_fptr + st % s_log_size;
+		u64 out_size = size;
+
+		if (std::memchr(data, s_record_marker, size))
+		{
+			// Format deferred messages
+			size = decode(st, size);
+			data = reinterpret_cast<const uchar*>(m_text.data());
+			out_size = m_text.size();
+		}
 
 		// Write uncompressed
-		if (m_fout && st < m_max_size && m_fout.write(m_fptr + st % s_log_size, size) != size)
+		if (m_fout && st < m_max_size && m_fout.write(data, out_size) != out_size)
 		{
 			m_fout.close();
 		}
@@ -503,8 +706,8 @@ bool logs::file_writer::flush(u64 bufv)
 		// Write compressed
 		if (m_fout2 && st < m_max_size)
 		{
-			m_zs.avail_in = size;
-			m_zs.next_in  = m_fptr + st % s_log_size;
+			m_zs.avail_in = static_cast<uInt>(out_size);
+			m_zs.next_in  = const_cast<uchar*>(data);
 
 			do
 			{
@@ -609,46 +812,40 @@ void logs::file_listener::log(u64 stamp, const logs::message& msg, const std::st
 {
 	thread_local std::string text;
 
-	// Used character: U+00B7 (Middle Dot)
-	switch (msg.sev)
-	{
-	case level::always:  text = u8"·A "; break;
-	case level::fatal:   text = u8"·F "; break;
-	case level::error:   text = u8"·E "; break;
-	case level::todo:    text = u8"·U "; break;
-	case level::success: text = u8"·S "; break;
-	case level::warning: text = u8"·W "; break;
-	case level::notice:  text = u8"·! "; break;
-	case level::trace:   text = u8"·T "; break;
-	case level::_uninit: text = u8"·  "; break;
-	}
+	text.clear();
+	format_line(text, stamp, msg, prefix, _text);
 
-	// Print µs timestamp
-	const u64 hours = stamp / 3600'000'000;
-	const u64 mins = (stamp % 3600'000'000) / 60'000'000;
-	const u64 secs = (stamp % 60'000'000) / 1'000'000;
-	const u64 frac = (stamp % 1'000'000);
-	fmt::append(text, "%u:%02u:%02u.%06u ", hours, mins, secs, frac);
+	file_writer::log(msg.sev, text.data(), text.size());
+}
 
-	if (prefix.size() > 0)
-	{
-		text += "{";
-		text += prefix;
-		text += "} ";
-	}
+void logs::file_listener::log_deferred(u64 stamp, const logs::message& msg, const std::string& prefix, const char* fmt, const fmt_type_info* sup, const u64* args)
+{
+	std::size_t argc = 0;
+	for (auto v = sup; v->fmt_string; v++)
+		argc++;
 
-	if (msg.ch && '\0' != *msg.ch->name)
-	{
-		text += msg.ch->name;
-		text += msg.sev == level::todo ? " TODO: " : ": ";
-	}
-	else if (msg.sev == level::todo)
+	if (argc > 0xff || prefix.size() > 0xffff)
 	{
-		text += "TODO: ";
+		std::string text;
+		fmt::raw_append(text, fmt, sup, args);
+		return log(stamp, msg, prefix, text);
 	}
 
-	text += _text;
-	text += '\n';
+	binary_record rec;
+	rec.marker = s_record_marker;
+	rec.argc = static_cast<u8>(argc);
+	rec.prefix_size = static_cast<u16>(prefix.size());
+	rec.size = static_cast<u32>(sizeof(rec) + argc * sizeof(u64) + prefix.size());
+	rec.stamp = stamp;
+	rec.msg = &msg;
+	rec.fmt = fmt;
+	rec.sup = sup;
 
-	file_writer::log(msg.sev, text.data(), text.size());
+	thread_local std::string data;
+
+	data.assign(reinterpret_cast<const char*>(&rec), sizeof(rec));
+	data.append(reinterpret_cast<const char*>(args), argc * sizeof(u64));
+	data += prefix;
+
+	file_writer::log(msg.sev, data.data(), data.size());
 }
@@ -23,6 +23,12 @@ namespace logs
 
 	struct channel;
 
+	// Format argument type passed by value (can be formatted later on the log writer thread)
+	template <typename T, typename = void>
+	struct deferrable : std::bool_constant<std::is_arithmetic<T>::value || std::is_enum<T>::value>
+	{
+	};
+
 	// Message information
 	struct message
 	{
@@ -33,6 +39,12 @@ namespace logs
 		// Send log message to global logger instance
 		void broadcast(const char*, const fmt_type_info*, ...) const;
 
+		// Send log message which doesn't reference temporary objects (formatting may be deferred)
+		void broadcast_deferred(const char*, const fmt_type_info*, ...) const;
+
+		// Format (or write in binary form) and send log message to all listeners
+		void dispatch(const char*, const fmt_type_info*, const u64* args, bool deferrable) const;
+
 		friend struct channel;
 	};
 
@@ -51,6 +63,9 @@ namespace logs
 		// Process log message
 		virtual void log(u64 stamp, const message& msg, const std::string& prefix, const std::string& text) = 0;
 
+		// Check if log() needs messages of given level (allows to skip formatting)
+		virtual bool is_enabled(level sev) const;
+
 		// Add new listener
 		static void add(listener*);
 	};
@@ -78,7 +93,10 @@ namespace logs
 			if (UNLIKELY(level::_sev <= enabled))\
 			{\
 				static constexpr fmt_type_info type_list[sizeof...(Args) + 1]{fmt_type_info::make<fmt_unveil_t<Args>>()...};\
-				msg_##_sev.broadcast(fmt, type_list, u64{fmt_unveil<Args>::get(args)}...);\
+				if constexpr ((deferrable<fmt_unveil_t<Args>>::value && ...))\
+					msg_##_sev.broadcast_deferred(fmt, type_list, u64{fmt_unveil<Args>::get(args)}...);\
+				else\
+					msg_##_sev.broadcast(fmt, type_list, u64{fmt_unveil<Args>::get(args)}...);\
 			}\
 		}
 
@@ -108,6 +126,9 @@ namespace logs
 
 	// Log level control: register channel if necessary, set channel level
 	void set_level(const std::string&, level);
+
+	// Write messages with plain arguments in binary form, formatting them on the writer thread
+	void set_deferred(bool);
 }
 
 #define LOG_CHANNEL(ch, ...) ::logs::channel ch(#ch, ##__VA_ARGS__);
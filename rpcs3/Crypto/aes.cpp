@@ -31,6 +31,12 @@
 
 #include "aes.h"
 
+#if defined(_MSC_VER) || (defined(__AES__) && defined(__SSSE3__))
+#define POLARSSL_HAVE_AESNI
+#include "Utilities/sysinfo.h"
+#include <immintrin.h>
+#endif
+
 /*
  * 32-bit integer manipulation macros (little endian)
  */
@@ -632,6 +638,79 @@ int aes_setkey_dec( aes_context *ctx, const unsigned char *key, unsigned int key
                  RT3[ ( Y0 >> 24 ) & 0xFF ];    \
 }
 
+#if defined(POLARSSL_HAVE_AESNI)
+/*
+ * AES-NI encryption of up to 4 independent blocks (interleaved to hide the AESENC latency)
+ */
+template <int Count>
+static inline void aesni_encrypt_blocks( const aes_context *ctx, __m128i *blocks )
+{
+    const __m128i *RK = reinterpret_cast<const __m128i*>( ctx->rk );
+    int i, r;
+
+    for( i = 0; i < Count; i++ )
+        blocks[i] = _mm_xor_si128( blocks[i], _mm_loadu_si128( RK ) );
+
+    for( r = 1; r < ctx->nr; r++ )
+    {
+        const __m128i key = _mm_loadu_si128( RK + r );
+
+        for( i = 0; i < Count; i++ )
+            blocks[i] = _mm_aesenc_si128( blocks[i], key );
+    }
+
+    const __m128i last = _mm_loadu_si128( RK + ctx->nr );
+
+    for( i = 0; i < Count; i++ )
+        blocks[i] = _mm_aesenclast_si128( blocks[i], last );
+}
+
+/*
+ * AES-NI CTR keystream for whole blocks (big-endian 128-bit counter)
+ */
+static void aesni_crypt_ctr_blocks( const aes_context *ctx,
+                                    size_t blocks,
+                                    unsigned char nonce_counter[16],
+                                    const unsigned char *input,
+                                    unsigned char *output )
+{
+    const __m128i bswap = _mm_set_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+
+    // Counter as a native 128-bit integer
+    const __m128i ctr = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( nonce_counter ) ), bswap );
+    uint64_t lo = _mm_cvtsi128_si64( ctr );
+    uint64_t hi = _mm_cvtsi128_si64( _mm_unpackhi_epi64( ctr, ctr ) );
+
+    const auto next = [&]()
+    {
+        const __m128i block = _mm_shuffle_epi8( _mm_set_epi64x( hi, lo ), bswap );
+        hi += ++lo == 0;
+        return block;
+    };
+
+    for( ; blocks >= 4; blocks -= 4, input += 64, output += 64 )
+    {
+        __m128i data[4] = { next(), next(), next(), next() };
+
+        aesni_encrypt_blocks<4>( ctx, data );
+
+        for( int i = 0; i < 4; i++ )
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( output ) + i, _mm_xor_si128( data[i], _mm_loadu_si128( reinterpret_cast<const __m128i*>( input ) + i ) ) );
+    }
+
+    for( ; blocks; blocks--, input += 16, output += 16 )
+    {
+        __m128i data[1] = { next() };
+
+        aesni_encrypt_blocks<1>( ctx, data );
+
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( output ), _mm_xor_si128( data[0], _mm_loadu_si128( reinterpret_cast<const __m128i*>( input ) ) ) );
+    }
+
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( nonce_counter ), _mm_shuffle_epi8( _mm_set_epi64x( hi, lo ), bswap ) );
+}
+#endif
+
 /*
  * AES-ECB block encryption/decryption
  */
@@ -643,6 +722,16 @@ int aes_crypt_ecb( aes_context *ctx,
     int i;
     uint32_t *RK, X0, X1, X2, X3, Y0, Y1, Y2, Y3;
 
+#if defined(POLARSSL_HAVE_AESNI)
+    if( mode == AES_ENCRYPT && utils::has_aesni() )
+    {
+        __m128i data[1] = { _mm_loadu_si128( reinterpret_cast<const __m128i*>( input ) ) };
+        aesni_encrypt_blocks<1>( ctx, data );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( output ), data[0] );
+        return( 0 );
+    }
+#endif
+
     RK = ctx->rk;
 
     GET_UINT32_LE( X0, input,  0 ); X0 ^= *RK++;
@@ -839,6 +928,19 @@ int aes_crypt_ctr( aes_context *ctx,
     int c, i;
     size_t n = *nc_off;
 
+#if defined(POLARSSL_HAVE_AESNI)
+    if( n == 0 && length >= 16 && utils::has_aesni() )
+    {
+        const size_t blocks = length / 16;
+
+        aesni_crypt_ctr_blocks( ctx, blocks, nonce_counter, input, output );
+
+        input += blocks * 16;
+        output += blocks * 16;
+        length -= blocks * 16;
+    }
+#endif
+
     while( length-- )
     {
         if( n == 0 ) {
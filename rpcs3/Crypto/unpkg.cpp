@@ -4,10 +4,43 @@
 #include "sha1.h"
 #include "key_vault.h"
 #include "Utilities/StrFmt.h"
+#include "Utilities/Thread.h"
 #include "Emu/System.h"
 #include "Emu/VFS.h"
 #include "unpkg.h"
 
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace
+{
+	// File being written by the installation pipeline
+	struct pkg_output
+	{
+		fs::file file;
+		std::string name;
+		std::string path;
+		bool overwritten = false;
+		bool failed = false;
+	};
+
+	// Block of file data passing through the installation pipeline (read -> decrypt -> write)
+	struct pkg_chunk
+	{
+		std::unique_ptr<u128[]> buf;
+		std::shared_ptr<pkg_output> out;
+		const uchar* key = nullptr;
+		u64 offset = 0; // Position in the PKG data area
+		u64 size = 0;
+		u32 pieces = 0; // Number of decryption jobs
+		u32 next_piece = 0; // Next decryption job to take
+		u32 pending = 0; // Decryption jobs not finished yet
+		bool last = false; // Last chunk of the file
+	};
+}
+
 bool pkg_install(const std::string& path, atomic_t<double>& sync)
 {
 	const std::size_t BUF_SIZE = 8192 * 1024; // 8 MB
@@ -219,16 +252,11 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 	// Allocate buffer with BUF_SIZE size or more if required
 	const std::unique_ptr<u128[]> buf(new u128[std::max<u64>(BUF_SIZE, sizeof(PKGEntry) * header.file_count) / sizeof(u128)]);
 
-	// Define decryption subfunction (`psp` arg selects the key for specific block)
-	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	// Decrypt the data in place (may be called concurrently, `offset` is the position of the data in the PKG data area)
+	auto decrypt_data = [&](u128* data, u64 offset, u64 size, const uchar* key)
 	{
-		archive_seek(header.data_offset + offset);
-
-		// Read the data and set available size
-		const u64 read = archive_read(buf.get(), size);
-
 		// Get block count
-		const u64 blocks = (read + 15) / 16;
+		const u64 blocks = (size + 15) / 16;
 
 		if (header.pkg_type == PKG_RELEASE_TYPE_DEBUG)
 		{
@@ -254,7 +282,7 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 				
 				sha1(reinterpret_cast<const u8*>(input), sizeof(input), hash.data);
 
-				buf[i] ^= hash._v128;
+				data[i] ^= hash._v128;
 			}
 		}
 
@@ -265,19 +293,25 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 			// Set encryption key for stream cipher
 			aes_setkey_enc(&ctx, key, 128);
 
-			// Initialize stream cipher for start position
+			// Initialize stream cipher for start position (big-endian counter incremented for every block)
 			be_t<u128> input = header.klicensee.value() + offset / 16;
 
-			// Increment stream position for every block
-			for (u64 i = 0; i < blocks; i++, input++)
-			{
-				u128 key;
-
-				aes_crypt_ecb(&ctx, AES_ENCRYPT, reinterpret_cast<const u8*>(&input), reinterpret_cast<u8*>(&key));
+			uchar stream[16];
+			std::size_t stream_pos = 0;
 
-				buf[i] ^= key;
-			}
+			aes_crypt_ctr(&ctx, blocks * 16, &stream_pos, reinterpret_cast<uchar*>(&input), stream, reinterpret_cast<const uchar*>(data), reinterpret_cast<uchar*>(data));
 		}
+	};
+
+	// Define decryption subfunction (`psp` arg selects the key for specific block)
+	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	{
+		archive_seek(header.data_offset + offset);
+
+		// Read the data and set available size
+		const u64 read = archive_read(buf.get(), size);
+
+		decrypt_data(buf.get(), offset, read, key);
 
 		// Return the amount of data written in buf
 		return read;
@@ -306,6 +340,211 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 
 	std::memcpy(entries.data(), buf.get(), entries.size() * sizeof(PKGEntry));
 
+	// Size of a decryption job
+	const u64 PIECE_SIZE = 256 * 1024;
+
+	// File data is read on this thread, decrypted by the workers and written in order by the writer thread
+	std::mutex pipe_mutex;
+	std::condition_variable pipe_cv;
+	std::deque<pkg_chunk*> pipe_queue; // Chunks read and not yet written
+	std::vector<std::unique_ptr<pkg_chunk>> pipe_chunks(4);
+	std::vector<pkg_chunk*> pipe_free; // Chunks available for reading
+	bool pipe_stop = false;
+	bool pipe_cancelled = false;
+
+	for (auto& chunk : pipe_chunks)
+	{
+		chunk = std::make_unique<pkg_chunk>();
+		chunk->buf.reset(new u128[BUF_SIZE / sizeof(u128)]);
+		pipe_free.push_back(chunk.get());
+	}
+
+	auto decrypt_worker = [&]()
+	{
+		std::unique_lock lock(pipe_mutex);
+
+		while (true)
+		{
+			// Take the first decryption job available
+			const auto found = std::find_if(pipe_queue.begin(), pipe_queue.end(), [](pkg_chunk* chunk) { return chunk->next_piece < chunk->pieces; });
+
+			if (found == pipe_queue.end())
+			{
+				if (pipe_stop)
+				{
+					break;
+				}
+
+				pipe_cv.wait(lock);
+				continue;
+			}
+
+			pkg_chunk& chunk = **found;
+			const u64 pos = chunk.next_piece++ * PIECE_SIZE;
+
+			lock.unlock();
+			decrypt_data(chunk.buf.get() + pos / sizeof(u128), chunk.offset + pos, std::min<u64>(PIECE_SIZE, chunk.size - pos), chunk.key);
+			lock.lock();
+
+			if (--chunk.pending == 0)
+			{
+				pipe_cv.notify_all();
+			}
+		}
+	};
+
+	auto write_worker = [&]()
+	{
+		std::unique_lock lock(pipe_mutex);
+
+		while (true)
+		{
+			if (pipe_queue.empty() || pipe_queue.front()->pending)
+			{
+				if (pipe_stop && pipe_queue.empty())
+				{
+					break;
+				}
+
+				pipe_cv.wait(lock);
+				continue;
+			}
+
+			pkg_chunk& chunk = *pipe_queue.front();
+			pipe_queue.pop_front();
+			const bool cancelled = pipe_cancelled;
+			lock.unlock();
+
+			pkg_output& out = *chunk.out;
+
+			if (!cancelled && !out.failed && chunk.size)
+			{
+				if (out.file.write(chunk.buf.get(), chunk.size) != chunk.size)
+				{
+					LOG_ERROR(LOADER, "Failed to write file %s", out.path);
+					out.failed = true;
+				}
+				else if (sync.fetch_add((chunk.size + 0.0) / header.data_size) < 0.)
+				{
+					if (was_null)
+					{
+						LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
+						lock.lock();
+						pipe_cancelled = true;
+						lock.unlock();
+					}
+					else
+					{
+						// Cannot cancel the installation
+						sync += 1.;
+					}
+				}
+			}
+
+			if (chunk.last && !cancelled)
+			{
+				if (out.overwritten)
+				{
+					LOG_WARNING(LOADER, "Overwritten file %s", out.name);
+				}
+				else
+				{
+					LOG_NOTICE(LOADER, "Created file %s", out.name);
+				}
+			}
+
+			chunk.out.reset();
+
+			lock.lock();
+			pipe_free.push_back(&chunk);
+			pipe_cv.notify_all();
+		}
+	};
+
+	std::vector<std::unique_ptr<named_thread<decltype(decrypt_worker)>>> decrypt_threads(std::clamp(std::thread::hardware_concurrency(), 1u, 8u));
+
+	for (auto& thread : decrypt_threads)
+	{
+		thread = std::make_unique<named_thread<decltype(decrypt_worker)>>("PKG Decrypt", decrypt_worker);
+	}
+
+	named_thread<decltype(write_worker)> write_thread("PKG Writer", write_worker);
+
+	// Stop the pipeline and wait for the workers (returns true if the installation was cancelled)
+	auto finish_pipeline = [&]() -> bool
+	{
+		{
+			std::lock_guard lock(pipe_mutex);
+			pipe_stop = true;
+			pipe_cv.notify_all();
+		}
+
+		for (auto& thread : decrypt_threads)
+		{
+			(*thread)();
+		}
+
+		write_thread();
+		return pipe_cancelled;
+	};
+
+	// Set by queue_chunk if the file data couldn't be read
+	bool read_failed = false;
+
+	// Queue a chunk of the file for decryption and writing (returns false if the installation was cancelled or on read error)
+	auto queue_chunk = [&](const std::shared_ptr<pkg_output>& out, u64 offset, u64 size, const uchar* key, bool last) -> bool
+	{
+		pkg_chunk* chunk;
+
+		{
+			std::unique_lock lock(pipe_mutex);
+
+			while (pipe_free.empty() && !pipe_cancelled)
+			{
+				pipe_cv.wait(lock);
+			}
+
+			if (pipe_cancelled)
+			{
+				return false;
+			}
+
+			chunk = pipe_free.back();
+			pipe_free.pop_back();
+		}
+
+		chunk->out = out;
+		chunk->key = key;
+		chunk->offset = offset;
+		chunk->last = last;
+		chunk->size = 0;
+
+		if (size)
+		{
+			archive_seek(header.data_offset + offset);
+
+			if (archive_read(chunk->buf.get(), size) == size)
+			{
+				chunk->size = size;
+			}
+			else
+			{
+				LOG_ERROR(LOADER, "Failed to extract file %s", out->path);
+				chunk->last = true;
+				read_failed = true;
+			}
+		}
+
+		chunk->pieces = static_cast<u32>((chunk->size + PIECE_SIZE - 1) / PIECE_SIZE);
+		chunk->next_piece = 0;
+		chunk->pending = chunk->pieces;
+
+		std::lock_guard lock(pipe_mutex);
+		pipe_queue.push_back(chunk);
+		pipe_cv.notify_all();
+		return !read_failed;
+	};
+
 	for (const auto& entry : entries)
 	{
 		const bool is_psp = (entry.type & PKG_FILE_ENTRY_PSP) != 0;
@@ -346,47 +585,39 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 				break;
 			}
 
-			if (fs::file out{path, fs::rewrite})
+			if (fs::file file{path, fs::rewrite})
 			{
-				for (u64 pos = 0; pos < entry.file_size; pos += BUF_SIZE)
-				{
-					const u64 block_size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
+				const auto out = std::make_shared<pkg_output>();
+				out->file = std::move(file);
+				out->name = name;
+				out->path = path;
+				out->overwritten = did_overwrite;
 
-					if (decrypt(entry.file_offset + pos, block_size, is_psp ? PKG_AES_KEY2 : dec_key.data()) != block_size)
-					{
-						LOG_ERROR(LOADER, "Failed to extract file %s", path);
-						break;
-					}
+				u64 pos = 0;
 
-					if (out.write(buf.get(), block_size) != block_size)
-					{
-						LOG_ERROR(LOADER, "Failed to write file %s", path);
-						break;
-					}
+				do
+				{
+					const u64 block_size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
+					const bool last = pos + block_size >= entry.file_size;
 
-					if (sync.fetch_add((block_size + 0.0) / header.data_size) < 0.)
+					if (!queue_chunk(out, entry.file_offset + pos, block_size, is_psp ? PKG_AES_KEY2 : dec_key.data(), last))
 					{
-						if (was_null)
+						if (read_failed)
 						{
-							LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
-							out.close();
-							fs::remove_all(dir, true);
-							return false;
+							// The failed chunk was queued as the last one, skip the rest of the file
+							read_failed = false;
+							break;
 						}
 
-						// Cannot cancel the installation
-						sync += 1.;
+						finish_pipeline();
+						out->file.close();
+						fs::remove_all(dir, true);
+						return false;
 					}
-				}
 
-				if (did_overwrite)
-				{
-					LOG_WARNING(LOADER, "Overwritten file %s", name);
-				}
-				else
-				{
-					LOG_NOTICE(LOADER, "Created file %s", name);
+					pos += block_size;
 				}
+				while (pos < entry.file_size);
 			}
 			else
 			{
@@ -424,6 +655,12 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 		}
 	}
 
+	if (finish_pipeline())
+	{
+		fs::remove_all(dir, true);
+		return false;
+	}
+
 	LOG_SUCCESS(LOADER, "Package successfully installed to %s", dir);
 	return true;
 }
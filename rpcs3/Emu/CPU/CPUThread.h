@@ -22,6 +22,17 @@ enum class cpu_flag : u32
 	__bitset_enum_max
 };
 
+class cpu_thread;
+class lv2_wait_queue;
+
+// Links of the lv2 wait queue containing the thread (stored in derived classes to keep cpu_thread layout)
+struct lv2_wait_link
+{
+	cpu_thread* prev = nullptr;
+	cpu_thread* next = nullptr;
+	lv2_wait_queue* queue = nullptr;
+};
+
 class cpu_thread
 {
 	// PPU cache backward compatibility hack
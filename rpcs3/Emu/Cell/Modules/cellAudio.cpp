@@ -5,6 +5,7 @@
 
 #include "Emu/Cell/lv2/sys_event.h"
 #include "cellAudio.h"
+#include "Utilities/sysinfo.h"
 #include <atomic>
 #include <cmath>
 
@@ -734,159 +735,181 @@ void cell_audio_thread::operator()()
 	ringbuffer.reset();
 }
 
-template <bool DownmixToStereo>
-void cell_audio_thread::mix(float *out_buffer, s32 offset)
+namespace
 {
-	AUDIT(out_buffer != nullptr);
+	const bool s_use_ssse3 = utils::has_ssse3();
 
-	constexpr u32 channels = DownmixToStereo ? 2 : 8;
-	constexpr u32 out_buffer_sz = channels * AUDIO_BUFFER_SAMPLES;
+	// Load 4 big-endian floats
+	template <bool Ssse3>
+	inline __m128 load_be_ps(const void* ptr)
+	{
+		const __m128i v = _mm_loadu_si128(static_cast<const __m128i*>(ptr));
 
-	bool first_mix = true;
+#if defined (_MSC_VER) || defined (__SSSE3__)
+		if constexpr (Ssse3)
+		{
+			return _mm_castsi128_ps(_mm_shuffle_epi8(v, _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)));
+		}
+#endif
 
-	// mixing
-	for (auto& port : ports)
+		const __m128i v1 = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		return _mm_castsi128_ps(_mm_or_si128(_mm_slli_epi32(v1, 16), _mm_srli_epi32(v1, 16)));
+	}
+
+	template <bool Accumulate>
+	inline void store_mix(float* out, __m128 v)
 	{
-		if (port.state != audio_port_state::started) continue;
+		_mm_store_ps(out, Accumulate ? _mm_add_ps(_mm_load_ps(out), v) : v);
+	}
 
-		auto buf = port.get_vm_ptr(offset);
-		static const float k = 1.0f;
-		float& m = port.level;
+	// Mix one port block (byteswap, per-frame volume, downmix and accumulation in one pass)
+	template <bool Ssse3, u32 InChannels, bool DownmixToStereo, bool Accumulate>
+	void mix_port(float* out, const to_be_t<float>* in, const float* volume)
+	{
+		const __m128 zero = _mm_setzero_ps();
 
-		// part of cellAudioSetPortLevel functionality
-		// spread port volume changes over 13ms
-		auto step_volume = [](audio_port& port)
+		if constexpr (InChannels == 2)
 		{
-			const auto param = port.level_set.load();
-
-			if (param.inc != 0.0f)
+			for (u32 i = 0; i < AUDIO_BUFFER_SAMPLES; i += 4, in += 8)
 			{
-				port.level += param.inc;
-				const bool dec = param.inc < 0.0f;
+				// Volumes of 4 frames, duplicated for L and R
+				const __m128 vol = _mm_load_ps(volume + i);
+				const __m128 s0 = _mm_mul_ps(load_be_ps<Ssse3>(in + 0), _mm_unpacklo_ps(vol, vol));
+				const __m128 s1 = _mm_mul_ps(load_be_ps<Ssse3>(in + 4), _mm_unpackhi_ps(vol, vol));
 
-				if ((!dec && param.value - port.level <= 0.0f) || (dec && param.value - port.level >= 0.0f))
+				if constexpr (DownmixToStereo)
 				{
-					port.level = param.value;
-					port.level_set.compare_and_swap(param, { param.value, 0.0f });
+					store_mix<Accumulate>(out + i * 2 + 0, s0);
+					store_mix<Accumulate>(out + i * 2 + 4, s1);
 				}
-			}
-		};
-
-		if (port.num_channels == 2)
-		{
-			if (first_mix)
-			{
-				for (u32 out = 0, in = 0; out < out_buffer_sz; out += channels, in += 2)
+				else
 				{
-					step_volume(port);
-
-					const float left  = buf[in + 0] * m;
-					const float right = buf[in + 1] * m;
-
-					out_buffer[out + 0] = left;
-					out_buffer[out + 1] = right;
+					float* dst = out + i * 8;
+					store_mix<Accumulate>(dst + 0, _mm_movelh_ps(s0, zero));
+					store_mix<Accumulate>(dst + 8, _mm_movehl_ps(zero, s0));
+					store_mix<Accumulate>(dst + 16, _mm_movelh_ps(s1, zero));
+					store_mix<Accumulate>(dst + 24, _mm_movehl_ps(zero, s1));
 
-					if constexpr (!DownmixToStereo)
+					if constexpr (!Accumulate)
 					{
-						out_buffer[out + 2] = 0.0f;
-						out_buffer[out + 3] = 0.0f;
-						out_buffer[out + 4] = 0.0f;
-						out_buffer[out + 5] = 0.0f;
-						out_buffer[out + 6] = 0.0f;
-						out_buffer[out + 7] = 0.0f;
+						_mm_store_ps(dst + 4, zero);
+						_mm_store_ps(dst + 12, zero);
+						_mm_store_ps(dst + 20, zero);
+						_mm_store_ps(dst + 28, zero);
 					}
 				}
-				first_mix = false;
 			}
-			else
-			{
-				for (u32 out = 0, in = 0; out < out_buffer_sz; out += channels, in += 2)
-				{
-					step_volume(port);
-
-					const float left  = buf[in + 0] * m;
-					const float right = buf[in + 1] * m;
+		}
+		else if constexpr (DownmixToStereo)
+		{
+			const __m128 mid_scale = _mm_set1_ps(0.708f);
 
-					out_buffer[out + 0] += left;
-					out_buffer[out + 1] += right;
-				}
+			// L' = L + RL + SL + (C + LFE) * 0.708, R' = R + RR + SR + (C + LFE) * 0.708
+			const auto downmix = [&](const to_be_t<float>* frame, float vol)
+			{
+				const __m128 a = load_be_ps<Ssse3>(frame + 0); // L, R, C, LFE
+				const __m128 b = load_be_ps<Ssse3>(frame + 4); // RL, RR, SL, SR
+				const __m128 c = _mm_movehl_ps(a, a);
+				const __m128 mid = _mm_mul_ps(_mm_add_ps(c, _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 3, 0, 1))), mid_scale);
+				const __m128 side = _mm_add_ps(b, _mm_movehl_ps(b, b));
+				return _mm_mul_ps(_mm_add_ps(_mm_add_ps(a, side), mid), _mm_set1_ps(vol));
+			};
+
+			for (u32 i = 0; i < AUDIO_BUFFER_SAMPLES; i += 2, in += 16)
+			{
+				store_mix<Accumulate>(out + i * 2, _mm_movelh_ps(downmix(in, volume[i]), downmix(in + 8, volume[i + 1])));
 			}
 		}
-		else if (port.num_channels == 8)
+		else
 		{
-			if (first_mix)
+			for (u32 i = 0; i < AUDIO_BUFFER_SAMPLES; i++, in += 8)
 			{
-				for (u32 out = 0, in = 0; out < out_buffer_sz; out += channels, in += 8)
-				{
-					step_volume(port);
-
-					const float left       = buf[in + 0] * m;
-					const float right      = buf[in + 1] * m;
-					const float center     = buf[in + 2] * m;
-					const float low_freq   = buf[in + 3] * m;
-					const float rear_left  = buf[in + 4] * m;
-					const float rear_right = buf[in + 5] * m;
-					const float side_left  = buf[in + 6] * m;
-					const float side_right = buf[in + 7] * m;
-
-					if constexpr (DownmixToStereo)
-					{
-						const float mid = (center + low_freq) * 0.708f;
-						out_buffer[out + 0] = (left + rear_left + side_left + mid) * k;
-						out_buffer[out + 1] = (right + rear_right + side_right + mid) * k;
-					}
-					else
-					{
-						out_buffer[out + 0] = left;
-						out_buffer[out + 1] = right;
-						out_buffer[out + 2] = center;
-						out_buffer[out + 3] = low_freq;
-						out_buffer[out + 4] = rear_left;
-						out_buffer[out + 5] = rear_right;
-						out_buffer[out + 6] = side_left;
-						out_buffer[out + 7] = side_right;
-					}
-				}
-				first_mix = false;
+				const __m128 vol = _mm_set1_ps(volume[i]);
+				store_mix<Accumulate>(out + i * 8 + 0, _mm_mul_ps(load_be_ps<Ssse3>(in + 0), vol));
+				store_mix<Accumulate>(out + i * 8 + 4, _mm_mul_ps(load_be_ps<Ssse3>(in + 4), vol));
 			}
-			else
+		}
+	}
+
+	template <bool Ssse3, bool DownmixToStereo, bool Accumulate>
+	void mix_port(float* out, const to_be_t<float>* in, const float* volume, u32 in_channels)
+	{
+		if (in_channels == 2)
+		{
+			mix_port<Ssse3, 2, DownmixToStereo, Accumulate>(out, in, volume);
+		}
+		else
+		{
+			mix_port<Ssse3, 8, DownmixToStereo, Accumulate>(out, in, volume);
+		}
+	}
+}
+
+template <bool DownmixToStereo>
+void cell_audio_thread::mix(float *out_buffer, s32 offset)
+{
+	AUDIT(out_buffer != nullptr);
+
+	constexpr u32 channels = DownmixToStereo ? 2 : 8;
+	constexpr u32 out_buffer_sz = channels * AUDIO_BUFFER_SAMPLES;
+
+	bool first_mix = true;
+
+	// Per-frame port volume
+	alignas(16) float volume[AUDIO_BUFFER_SAMPLES];
+
+	// mixing
+	for (auto& port : ports)
+	{
+		if (port.state != audio_port_state::started) continue;
+
+		if (port.num_channels != 2 && port.num_channels != 8)
+		{
+			fmt::throw_exception("Unknown channel count (port=%u, channel=%d)" HERE, port.number, port.num_channels);
+		}
+
+		// part of cellAudioSetPortLevel functionality
+		// spread port volume changes over 13ms
+		if (port.level_set.load().inc == 0.0f)
+		{
+			std::fill_n(volume, AUDIO_BUFFER_SAMPLES, port.level);
+		}
+		else
+		{
+			for (u32 i = 0; i < AUDIO_BUFFER_SAMPLES; i++)
 			{
-				for (u32 out = 0, in = 0; out < out_buffer_sz; out += channels, in += 8)
+				const auto param = port.level_set.load();
+
+				if (param.inc != 0.0f)
 				{
-					step_volume(port);
-
-					const float left       = buf[in + 0] * m;
-					const float right      = buf[in + 1] * m;
-					const float center     = buf[in + 2] * m;
-					const float low_freq   = buf[in + 3] * m;
-					const float rear_left  = buf[in + 4] * m;
-					const float rear_right = buf[in + 5] * m;
-					const float side_left  = buf[in + 6] * m;
-					const float side_right = buf[in + 7] * m;
-
-					if constexpr (DownmixToStereo)
-					{
-						const float mid = (center + low_freq) * 0.708f;
-						out_buffer[out + 0] += (left + rear_left + side_left + mid) * k;
-						out_buffer[out + 1] += (right + rear_right + side_right + mid) * k;
-					}
-					else
+					port.level += param.inc;
+					const bool dec = param.inc < 0.0f;
+
+					if ((!dec && param.value - port.level <= 0.0f) || (dec && param.value - port.level >= 0.0f))
 					{
-						out_buffer[out + 0] += left;
-						out_buffer[out + 1] += right;
-						out_buffer[out + 2] += center;
-						out_buffer[out + 3] += low_freq;
-						out_buffer[out + 4] += rear_left;
-						out_buffer[out + 5] += rear_right;
-						out_buffer[out + 6] += side_left;
-						out_buffer[out + 7] += side_right;
+						port.level = param.value;
+						port.level_set.compare_and_swap(param, { param.value, 0.0f });
 					}
 				}
+
+				volume[i] = port.level;
 			}
 		}
+
+		const auto buf = port.get_vm_ptr(offset);
+
+		if (first_mix)
+		{
+			s_use_ssse3
+				? mix_port<true, DownmixToStereo, false>(out_buffer, buf, volume, port.num_channels)
+				: mix_port<false, DownmixToStereo, false>(out_buffer, buf, volume, port.num_channels);
+			first_mix = false;
+		}
 		else
 		{
-			fmt::throw_exception("Unknown channel count (port=%u, channel=%d)" HERE, port.number, port.num_channels);
+			s_use_ssse3
+				? mix_port<true, DownmixToStereo, true>(out_buffer, buf, volume, port.num_channels)
+				: mix_port<false, DownmixToStereo, true>(out_buffer, buf, volume, port.num_channels);
 		}
 	}
 
@@ -5,11 +5,16 @@
 
 #include "Emu/Cell/lv2/sys_fs.h"
 #include "Emu/Cell/lv2/sys_sync.h"
+#include "Emu/Cell/lv2/sys_ppu_thread.h"
+#include "sysPrxForUser.h"
 #include "cellFs.h"
 
 #include "Utilities/StrUtil.h"
+#include "Utilities/lockless.h"
 
 #include <mutex>
+#include <deque>
+#include <condition_variable>
 
 
 
@@ -859,113 +864,279 @@ s32 cellFsStReadWaitCallback(u32 fd, u64 size, vm::ptr<void(s32 xfd, u64 xsize)>
 
 using fs_aio_cb_t = vm::ptr<void(vm::ptr<CellFsAio> xaio, s32 error, s32 xid, u64 size)>;
 
-// temporarily
-struct lv2_fs_mount_point
+// AIO request (CellFsAio fields are read on submission)
+struct fs_aio_request
+{
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
+	s32 xid;
+	bool write;
+	u32 fd;
+	u64 offset;
+	u32 buf;
+	u64 size;
+};
+
+// Completed AIO request waiting for its callback
+struct fs_aio_done
 {
-	std::mutex mutex;
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
+	s32 xid;
+	s32 error;
+	u64 result;
 };
 
-struct fs_aio_thread : ppu_thread
+struct fs_aio_manager
 {
-	using ppu_thread::ppu_thread;
+	// Max size of merged adjacent reads
+	static constexpr u64 max_merge_size = 4 * 1024 * 1024;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<fs_aio_request> requests; // Pending requests (workers complete them in any order)
+	bool stop = false;
+
+	// Host I/O workers
+	std::vector<std::unique_ptr<named_thread<std::function<void()>>>> workers;
+
+	// Completions for the callback thread
+	lf_queue<fs_aio_done> done;
+	cond_one done_cv;
+	atomic_t<bool> done_stop{false};
 
-	void non_task()
+	// Callback thread (guest PPU interrupt thread)
+	atomic_t<u32> ppu_tid{0};
+
+	void complete(const fs_aio_request& req, s32 error, u64 result)
+	{
+		done.push(fs_aio_done{req.aio, req.func, req.xid, error, result});
+		done_cv.notify();
+	}
+
+	// Perform a request or a batch of adjacent reads on the same file
+	void process(const std::vector<fs_aio_request>& batch)
 	{
-		while (cmd64 cmd = cmd_wait())
+		const auto& req = batch.front();
+
+		const auto file = idm::get<lv2_fs_object, lv2_file>(req.fd);
+
+		if (!file || (!req.write && file->flags & CELL_FS_O_WRONLY) || (req.write && !(file->flags & CELL_FS_O_ACCMODE)))
+		{
+			for (const auto& r : batch)
+			{
+				complete(r, CELL_EBADF, 0);
+			}
+
+			return;
+		}
+
+		if (batch.size() == 1)
+		{
+			u64 result;
+
+			{
+				std::lock_guard lock(file->mutex);
+
+				result = req.write
+					? file->op_write(vm::cast(req.buf), req.size, req.offset)
+					: file->op_read(vm::cast(req.buf), req.size, req.offset);
+			}
+
+			complete(req, CELL_OK, result);
+			return;
+		}
+
+		// Single host read, then scatter to the guest buffers
+		const u64 total = batch.back().offset + batch.back().size - req.offset;
+		std::unique_ptr<u8[]> local_buf(new u8[total]);
+
+		u64 nread;
+
 		{
-			const u32 type = cmd.arg1<u32>();
-			const s32 xid = cmd.arg2<s32>();
-			const cmd64 cmd2 = cmd_get(1);
-			const auto aio = cmd2.arg1<vm::ptr<CellFsAio>>();
-			const auto func = cmd2.arg2<fs_aio_cb_t>();
-			cmd_pop(1);
+			std::lock_guard lock(file->mutex);
+			nread = file->file.read_at(req.offset, local_buf.get(), total);
+		}
 
-			s32 error = CELL_OK;
-			u64 result = 0;
+		for (const auto& r : batch)
+		{
+			const u64 pos = r.offset - req.offset;
+			const u64 result = nread > pos ? std::min<u64>(r.size, nread - pos) : 0;
+			std::memcpy(vm::base(r.buf), local_buf.get() + pos, result);
+			complete(r, CELL_OK, result);
+		}
+	}
 
-			const auto file = idm::get<lv2_fs_object, lv2_file>(aio->fd);
+	void worker()
+	{
+		std::unique_lock lock(mutex);
 
-			if (!file || (type == 1 && file->flags & CELL_FS_O_WRONLY) || (type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+		while (true)
+		{
+			if (requests.empty())
 			{
-				error = CELL_EBADF;
+				if (stop)
+				{
+					break;
+				}
+
+				cv.wait(lock);
+				continue;
 			}
-			else
+
+			std::vector<fs_aio_request> batch;
+			batch.emplace_back(requests.front());
+			requests.pop_front();
+
+			// Merge queued reads continuing the previous one
+			for (auto it = requests.begin(); !batch.front().write && it != requests.end();)
 			{
-				std::lock_guard lock(file->mp->mutex);
+				const auto& last = batch.back();
 
-				const auto old_pos = file->file.pos(); file->file.seek(aio->offset);
+				if (!it->write && it->fd == last.fd && it->offset == last.offset + last.size && it->offset + it->size - batch.front().offset <= max_merge_size)
+				{
+					batch.emplace_back(*it);
+					requests.erase(it);
+					it = requests.begin();
+					continue;
+				}
 
-				result = type == 2
-					? file->op_write(aio->buf, aio->size)
-					: file->op_read(aio->buf, aio->size);
+				it++;
+			}
 
-				file->file.seek(old_pos);
+			lock.unlock();
+			process(batch);
+			lock.lock();
+		}
+	}
+
+	// Callback thread loop
+	void exec(ppu_thread& ppu)
+	{
+		std::unique_lock cv_lock(done_cv);
+
+		for (auto list = done.pop_all(); !Emu.IsStopped(); list ? list.pop_front() : list = done.pop_all())
+		{
+			if (!list)
+			{
+				if (done_stop)
+				{
+					break;
+				}
+
+				done_cv.wait(cv_lock, 1000);
+				continue;
 			}
 
-			func(*this, aio, error, xid, result);
-			lv2_obj::sleep(*this);
+			list->func(ppu, list->aio, list->error, list->xid, list->result);
+			lv2_obj::sleep(ppu);
+		}
+	}
+
+	// Stop host workers (requests still queued are completed first)
+	void stop_workers()
+	{
+		{
+			std::lock_guard lock(mutex);
+			stop = true;
+			cv.notify_all();
+		}
+
+		workers.clear();
+	}
+
+	~fs_aio_manager()
+	{
+		// Emulation stopped without cellFsAioFinish: discard pending requests and join the workers
+		{
+			std::lock_guard lock(mutex);
+			requests.clear();
 		}
+
+		stop_workers();
 	}
 };
 
-struct fs_aio_manager
+static void fsAioEntry(ppu_thread& ppu)
 {
-	std::shared_ptr<fs_aio_thread> thread;
-};
+	const auto m = fxm::get<fs_aio_manager>();
+
+	m->ppu_tid = ppu.id;
+	m->exec(ppu);
+
+	_sys_ppu_thread_exit(ppu, 0);
+}
 
-s32 cellFsAioInit(vm::cptr<char> mount_point)
+s32 cellFsAioInit(ppu_thread& ppu, vm::cptr<char> mount_point)
 {
 	cellFs.warning("cellFsAioInit(mount_point=%s)", mount_point);
 
-	// TODO: create AIO thread (if not exists) for specified mount point
+	// TODO: separate AIO engine for each mount point
 	const auto m = fxm::make<fs_aio_manager>();
 
-	fmt::throw_exception("cellFsAio disabled, use LLE.");
+	if (!m)
+	{
+		return CELL_OK;
+	}
 
-	return CELL_OK;
-}
+	const u32 count = g_cfg.vfs.aio_threads;
 
-s32 cellFsAioFinish(vm::cptr<char> mount_point)
-{
-	cellFs.warning("cellFsAioFinish(mount_point=%s)", mount_point);
+	for (u32 i = 0; i < count; i++)
+	{
+		m->workers.emplace_back(std::make_unique<named_thread<std::function<void()>>>(fmt::format("cellFsAio Worker %u", i), [m = m.get()] { m->worker(); }));
+	}
+
+	// Run callback thread
+	vm::var<u64> _tid;
+	vm::var<char[]> _name = vm::make_str("HLE FS AIO Thread");
+	ppu_execute<&sys_ppu_thread_create>(ppu, +_tid, 0, 0, 1001, 0x4000, SYS_PPU_THREAD_CREATE_INTERRUPT, +_name);
+
+	const auto thrd = idm::get<named_thread<ppu_thread>>(*_tid);
+
+	thrd->cmd_list
+	({
+		{ ppu_cmd::hle_call, FIND_FUNC(fsAioEntry) },
+	});
 
-	// TODO: delete existing AIO thread for specified mount point
+	thrd->state -= cpu_flag::stop;
+	thread_ctrl::notify(*thrd);
 
 	return CELL_OK;
 }
 
-atomic_t<s32> g_fs_aio_id;
-
-s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+s32 cellFsAioFinish(ppu_thread& ppu, vm::cptr<char> mount_point)
 {
-	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
-
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+	cellFs.warning("cellFsAioFinish(mount_point=%s)", mount_point);
 
 	const auto m = fxm::get<fs_aio_manager>();
 
 	if (!m)
 	{
-		return CELL_ENXIO;
+		return CELL_EINVAL;
 	}
 
-	const s32 xid = (*id = ++g_fs_aio_id);
+	lv2_obj::sleep(ppu);
+	m->stop_workers();
 
-	m->thread->cmd_list
-	({
-		{ 1, xid },
-		{ aio, func },
-	});
+	// Wait for the callback thread to deliver pending completions and exit
+	m->done_stop = true;
+	m->done_cv.notify();
+
+	while (!m->ppu_tid)
+	{
+		thread_ctrl::wait_for(1000);
+	}
 
+	ppu_execute<&sys_interrupt_thread_disestablish>(ppu, m->ppu_tid.load());
+
+	fxm::remove<fs_aio_manager>();
 	return CELL_OK;
 }
 
-s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
-{
-	cellFs.warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
-
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+atomic_t<s32> g_fs_aio_id;
 
+static s32 fs_aio_submit(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func, bool write)
+{
 	const auto m = fxm::get<fs_aio_manager>();
 
 	if (!m)
@@ -975,15 +1146,32 @@ s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 
 	const s32 xid = (*id = ++g_fs_aio_id);
 
-	m->thread->cmd_list
-	({
-		{ 2, xid },
-		{ aio, func },
-	});
+	std::lock_guard lock(m->mutex);
 
+	if (m->stop)
+	{
+		return CELL_ENXIO;
+	}
+
+	m->requests.emplace_back(fs_aio_request{aio, func, xid, write, aio->fd, aio->offset, aio->buf.addr(), aio->size});
+	m->cv.notify_one();
 	return CELL_OK;
 }
 
+s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.trace("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+
+	return fs_aio_submit(aio, id, func, false);
+}
+
+s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.trace("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+
+	return fs_aio_submit(aio, id, func, true);
+}
+
 s32 cellFsAioCancel(s32 id)
 {
 	cellFs.todo("cellFsAioCancel(id=%d) -> CELL_EINVAL", id);
@@ -1018,6 +1206,8 @@ DECLARE(ppu_module_manager::cellFs)("sys_fs", []()
 	REG_FUNC(sys_fs, cellFsAioInit);
 	REG_FUNC(sys_fs, cellFsAioRead);
 	REG_FUNC(sys_fs, cellFsAioWrite);
+
+	REG_FUNC(sys_fs, fsAioEntry).flag(MFF_HIDDEN);
 	REG_FUNC(sys_fs, cellFsAllocateFileAreaByFdWithInitialData);
 	REG_FUNC(sys_fs, cellFsAllocateFileAreaByFdWithoutZeroFill);
 	REG_FUNC(sys_fs, cellFsAllocateFileAreaWithInitialData);
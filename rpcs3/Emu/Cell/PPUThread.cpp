@@ -165,7 +165,8 @@ extern const ppu_decoder<ppu_interpreter_fast> g_ppu_interpreter_fast([](auto& t
 
 extern void ppu_initialize();
 extern void ppu_initialize(const ppu_module& info);
-static void ppu_initialize2(class jit_compiler& jit, const ppu_module& module_part, const std::string& cache_path, const std::string& obj_name);
+static void ppu_initialize(const ppu_module& info, bool precompile);
+static void ppu_initialize2(class jit_compiler& jit, const ppu_module& info, const std::vector<ppu_function>& funcs, const std::string& cache_path, const std::string& obj_name);
 extern void ppu_execute_syscall(ppu_thread& ppu, u64 code);
 
 // Get pointer to executable cache
@@ -1205,6 +1206,190 @@ extern bool ppu_stdcx(ppu_thread& ppu, u32 addr, u64 reg_value)
 	return result;
 }
 
+// PPU compilation job scheduler (work-stealing thread pool shared by all modules)
+class ppu_jit_pool
+{
+	struct job
+	{
+		// Unique key (object file path)
+		std::string key;
+
+		std::function<void()> func;
+
+		atomic_t<bool> done{false};
+	};
+
+	struct worker_queue
+	{
+		shared_mutex mutex;
+
+		// Own jobs are taken from the front, stolen from the back
+		std::deque<std::shared_ptr<job>> jobs;
+	};
+
+	// Protects m_map, used with m_cond
+	shared_mutex m_mutex;
+
+	cond_variable m_cond;
+
+	// Jobs in progress by key
+	std::unordered_map<std::string, std::shared_ptr<job>> m_map;
+
+	// Queue for each worker thread
+	std::unique_ptr<worker_queue[]> m_queues;
+
+	u32 m_count;
+
+	// Number of queued jobs
+	atomic_t<u32> m_queued{0};
+
+	// Next queue for submit()
+	atomic_t<u32> m_next{0};
+
+	std::deque<named_thread<std::function<void()>>> m_workers;
+
+	// Take a job from the queue (or steal it from another one) and run it
+	bool run_one(u32 index)
+	{
+		if (!m_queued)
+		{
+			return false;
+		}
+
+		for (u32 i = 0; i < m_count; i++)
+		{
+			auto& queue = m_queues[(index + i) % m_count];
+
+			std::shared_ptr<job> next;
+			{
+				std::lock_guard lock(queue.mutex);
+
+				if (queue.jobs.empty())
+				{
+					continue;
+				}
+
+				if (i == 0)
+				{
+					next = std::move(queue.jobs.front());
+					queue.jobs.pop_front();
+				}
+				else
+				{
+					next = std::move(queue.jobs.back());
+					queue.jobs.pop_back();
+				}
+			}
+
+			m_queued--;
+			next->func();
+			next->func = nullptr;
+			next->done = true;
+
+			{
+				std::lock_guard lock(m_mutex);
+				m_map.erase(next->key);
+			}
+
+			m_cond.notify_all();
+			return true;
+		}
+
+		return false;
+	}
+
+public:
+	ppu_jit_pool(u32 count)
+		: m_queues(std::make_unique<worker_queue[]>(count))
+		, m_count(count)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			m_workers.emplace_back(fmt::format("PPU Compiler %u", i), [this, i]()
+			{
+				// Set low priority
+				thread_ctrl::set_native_priority(-1);
+
+				while (!Emu.IsStopped())
+				{
+					if (run_one(i))
+					{
+						continue;
+					}
+
+					std::lock_guard lock(m_mutex);
+
+					if (!m_queued)
+					{
+						m_cond.wait(m_mutex, 10000);
+					}
+				}
+			});
+		}
+	}
+
+	// Add job unless a job with the same key is in progress (returns false in this case)
+	bool submit(const std::string& key, std::function<void()> func)
+	{
+		{
+			std::lock_guard lock(m_mutex);
+
+			auto& found = m_map[key];
+
+			if (found)
+			{
+				return false;
+			}
+
+			found = std::make_shared<job>();
+			found->key = key;
+			found->func = std::move(func);
+
+			auto& queue = m_queues[m_next++ % m_count];
+
+			std::lock_guard qlock(queue.mutex);
+			queue.jobs.emplace_back(found);
+			m_queued++;
+		}
+
+		m_cond.notify_all();
+		return true;
+	}
+
+	// Wait for the job with specified key, helping with other jobs meanwhile
+	void wait(const std::string& key)
+	{
+		std::shared_ptr<job> target;
+		{
+			reader_lock lock(m_mutex);
+
+			const auto found = m_map.find(key);
+
+			if (found == m_map.end())
+			{
+				return;
+			}
+
+			target = found->second;
+		}
+
+		while (!target->done)
+		{
+			if (run_one(m_next % m_count))
+			{
+				continue;
+			}
+
+			std::lock_guard lock(m_mutex);
+
+			if (!target->done)
+			{
+				m_cond.wait(m_mutex, 1000);
+			}
+		}
+	}
+};
+
 extern void ppu_initialize()
 {
 	const auto _main = fxm::get<ppu_module>();
@@ -1219,9 +1404,6 @@ extern void ppu_initialize()
 		return;
 	}
 
-	// Initialize main module
-	ppu_initialize(*_main);
-
 	std::vector<lv2_prx*> prx_list;
 
 	idm::select<lv2_obj, lv2_prx>([&](u32, lv2_prx& prx)
@@ -1229,6 +1411,15 @@ extern void ppu_initialize()
 		prx_list.emplace_back(&prx);
 	});
 
+	// Start compiling preloaded libraries in parallel with the main module
+	for (auto ptr : prx_list)
+	{
+		ppu_initialize(*ptr, true);
+	}
+
+	// Initialize main module
+	ppu_initialize(*_main);
+
 	// Initialize preloaded libraries
 	for (auto ptr : prx_list)
 	{
@@ -1240,9 +1431,19 @@ extern void ppu_initialize()
 }
 
 extern void ppu_initialize(const ppu_module& info)
+{
+	ppu_initialize(info, false);
+}
+
+static void ppu_initialize(const ppu_module& info, bool precompile)
 {
 	if (g_cfg.core.ppu_decoder != ppu_decoder_type::llvm)
 	{
+		if (precompile)
+		{
+			return;
+		}
+
 		// Temporarily
 		s_ppu_toc = fxm::get_always<std::unordered_map<u32, u32>>().get();
 
@@ -1335,6 +1536,14 @@ extern void ppu_initialize(const ppu_module& info)
 	}
 
 #ifdef LLVM_AVAILABLE
+	// Global content-addressed object store (the cache directory only contains the list of objects)
+	const std::string store_path = fs::get_cache_dir() + "cache/ppu-objects/";
+
+	if (!fs::create_path(store_path))
+	{
+		fmt::throw_exception("Failed to create cache directory: %s (%s)", store_path, fs::g_tls_error);
+	}
+
 	// Initialize progress dialog
 	g_progr = "Compiling PPU modules...";
 
@@ -1345,16 +1554,6 @@ extern void ppu_initialize(const ppu_module& info)
 		std::vector<ppu_function_t> funcs;
 	};
 
-	struct jit_core_allocator
-	{
-		::semaphore<0x7fffffff> sem;
-
-		jit_core_allocator(s32 arg)
-			: sem(arg)
-		{
-		}
-	};
-
 	// Permanently loaded compiled PPU modules (name -> data)
 	jit_module& jit_mod = fxm::get_always<std::unordered_map<std::string, jit_module>>()->emplace(cache_path + info.name, jit_module{}).first->second;
 
@@ -1364,13 +1563,16 @@ extern void ppu_initialize(const ppu_module& info)
 	// Compiler mutex (global)
 	static shared_mutex jmutex;
 
-	// Initialize global semaphore with the max number of threads
+	// Initialize global thread pool with the max number of threads
 	u32 max_threads = static_cast<u32>(g_cfg.core.llvm_threads);
-	s32 thread_count = max_threads > 0 ? std::min(max_threads, std::thread::hardware_concurrency()) : std::thread::hardware_concurrency();
-	const auto jcores = fxm::get_always<jit_core_allocator>(std::max<s32>(thread_count, 1));
+	u32 thread_count = max_threads > 0 ? std::min(max_threads, std::thread::hardware_concurrency()) : std::thread::hardware_concurrency();
+	const auto jpool = fxm::get_always<ppu_jit_pool>(std::max<u32>(thread_count, 1));
 
-	// Worker threads
-	std::vector<std::thread> jthreads;
+	// Object files being compiled for this module
+	std::vector<std::string> jobjects;
+
+	// All object files of this module (manifest)
+	std::vector<std::string> objects;
 
 	// Global variables to initialize
 	std::vector<std::pair<std::string, u64>> globals;
@@ -1384,7 +1586,7 @@ extern void ppu_initialize(const ppu_module& info)
 	while (jit_mod.vars.empty() && fpos < info.funcs.size())
 	{
 		// Initialize compiler instance
-		if (!jit && get_current_cpu_thread())
+		if (!jit && !precompile && get_current_cpu_thread())
 		{
 			jit = std::make_shared<jit_compiler>(s_link_table, g_cfg.core.llvm_cpu);
 		}
@@ -1392,10 +1594,9 @@ extern void ppu_initialize(const ppu_module& info)
 		// First function in current module part
 		const auto fstart = fpos;
 
-		// Copy module information (TODO: optimize)
-		ppu_module part;
-		part.copy_part(info);
-		part.funcs.reserve(16000);
+		// Functions of the module part (other module information is shared)
+		std::vector<ppu_function> part;
+		part.reserve(16000);
 
 		// Unique suffix for each module part
 		const u32 suffix = info.funcs.at(fstart).addr - reloc;
@@ -1422,7 +1623,7 @@ extern void ppu_initialize(const ppu_module& info)
 				entry.size = block.second;
 				entry.toc  = func.toc;
 				fmt::append(entry.name, "__0x%x", block.first - reloc);
-				part.funcs.emplace_back(std::move(entry));
+				part.emplace_back(std::move(entry));
 			}
 
 			fpos++;
@@ -1430,12 +1631,15 @@ extern void ppu_initialize(const ppu_module& info)
 
 		// Compute module hash to generate (hopefully) unique object name
 		std::string obj_name;
+
+		// Object name used in the module cache directory before the global store
+		std::string old_name;
 		{
 			sha1_context ctx;
 			u8 output[20];
 			sha1_starts(&ctx);
 
-			for (const auto& func : part.funcs)
+			for (const auto& func : part)
 			{
 				if (func.size == 0)
 				{
@@ -1455,8 +1659,8 @@ extern void ppu_initialize(const ppu_module& info)
 					}
 
 					// Find relevant relocations
-					auto low = std::lower_bound(part.relocs.cbegin(), part.relocs.cend(), block.first);
-					auto high = std::lower_bound(low, part.relocs.cend(), block.first + block.second);
+					auto low = std::lower_bound(info.relocs.cbegin(), info.relocs.cend(), block.first);
+					auto high = std::lower_bound(low, info.relocs.cend(), block.first + block.second);
 					auto addr = block.first;
 
 					for (; low != high; ++low)
@@ -1496,7 +1700,17 @@ extern void ppu_initialize(const ppu_module& info)
 				sha1_update(&ctx, reinterpret_cast<const u8*>(&forced_upd), sizeof(forced_upd));
 			}
 
+			// Code of relocatable modules isn't hashed (it's modified by relocations), so add the module hash for the global store
+			sha1_context ctx2 = ctx;
+			u8 output2[20];
+
+			if (reloc)
+			{
+				sha1_update(&ctx2, info.sha1, sizeof(info.sha1));
+			}
+
 			sha1_finish(&ctx, output);
+			sha1_finish(&ctx2, output2);
 
 			// Settings: should be populated by settings which affect codegen (TODO)
 			enum class ppu_settings : u32
@@ -1513,7 +1727,8 @@ extern void ppu_initialize(const ppu_module& info)
 #endif
 
 			// Write version, hash, CPU, settings
-			fmt::append(obj_name, "v1-tane-%s-%s-%s.obj", fmt::base57(output, 16), fmt::base57(settings), jit_compiler::cpu(g_cfg.core.llvm_cpu));
+			fmt::append(obj_name, "v1-tane-%s-%s-%s.obj", fmt::base57(output2, 16), fmt::base57(settings), jit_compiler::cpu(g_cfg.core.llvm_cpu));
+			fmt::append(old_name, "v1-tane-%s-%s-%s.obj", fmt::base57(output, 16), fmt::base57(settings), jit_compiler::cpu(g_cfg.core.llvm_cpu));
 		}
 
 		if (Emu.IsStopped())
@@ -1530,64 +1745,125 @@ extern void ppu_initialize(const ppu_module& info)
 			globals.emplace_back(fmt::format("__seg%u_%x", i, suffix), info.segs[i].addr);
 		}
 
+		// Register object in the module manifest
+		objects.emplace_back(obj_name);
+
+		// Move the object compiled before the global store was introduced
+		if (!fs::is_file(store_path + obj_name) && fs::is_file(cache_path + old_name))
+		{
+			if (!fs::rename(cache_path + old_name, store_path + obj_name, false))
+			{
+				LOG_ERROR(PPU, "LLVM: Failed to move %s to the object store (%s)", old_name, fs::g_tls_error);
+			}
+		}
+
 		// Check object file
-		if (fs::is_file(cache_path + obj_name))
+		if (fs::is_file(store_path + obj_name))
 		{
 			if (!jit)
 			{
-				LOG_SUCCESS(PPU, "LLVM: Already exists: %s", obj_name);
-				continue;
+				// Objects in the store are shared between titles, validate them when precompiling too
+				if (jit_compiler::check(store_path + obj_name))
+				{
+					LOG_SUCCESS(PPU, "LLVM: Already exists: %s", obj_name);
+					continue;
+				}
+			}
+			else
+			{
+				bool loaded;
+				{
+					std::lock_guard lock(jmutex);
+					loaded = jit->add(store_path + obj_name);
+				}
+
+				if (loaded)
+				{
+					LOG_SUCCESS(PPU, "LLVM: Loaded module %s", obj_name);
+					continue;
+				}
 			}
 
-			std::lock_guard lock(jmutex);
-			jit->add(cache_path + obj_name);
+			// Truncated or corrupt object: evict it from the store and compile the module again
+			LOG_ERROR(PPU, "LLVM: Invalid module %s in the object store, recompiling", obj_name);
 
-			LOG_SUCCESS(PPU, "LLVM: Loaded module %s", obj_name);
-			continue;
+			if (!fs::remove_file(store_path + obj_name))
+			{
+				fmt::throw_exception("LLVM: Failed to remove invalid module %s (%s)" HERE, obj_name, fs::g_tls_error);
+			}
 		}
 
 		// Update progress dialog
 		g_progr_ptotal++;
 
-		// Create worker thread for compilation
-		jthreads.emplace_back([&jit, obj_name = obj_name, part = std::move(part), &cache_path, jcores]()
+		if (!jpool->submit(store_path + obj_name, [&info, obj_name = obj_name, part = std::move(part), store_path]()
 		{
-			// Set low priority
-			thread_ctrl::set_native_priority(-1);
-
-			// Allocate "core"
+			if (!Emu.IsStopped())
 			{
-				std::lock_guard jlock(jcores->sem);
+				LOG_WARNING(PPU, "LLVM: Compiling module %s%s", store_path, obj_name);
 
-				if (!Emu.IsStopped())
-				{
-					LOG_WARNING(PPU, "LLVM: Compiling module %s%s", cache_path, obj_name);
+				// Use another JIT instance
+				jit_compiler jit2({}, g_cfg.core.llvm_cpu, 0x1);
+				ppu_initialize2(jit2, info, part, store_path, obj_name);
+			}
 
-					// Use another JIT instance
-					jit_compiler jit2({}, g_cfg.core.llvm_cpu, 0x1);
-					ppu_initialize2(jit2, part, cache_path, obj_name);
-				}
+			g_progr_pdone++;
+		}))
+		{
+			// Already in progress
+			g_progr_ptotal--;
+		}
 
-				g_progr_pdone++;
-			}
+		jobjects.emplace_back(obj_name);
+	}
 
-			if (Emu.IsStopped() || !jit || !fs::is_file(cache_path + obj_name))
-			{
-				return;
-			}
+	if (precompile)
+	{
+		// Don't wait (the module must be initialized normally later)
+		return;
+	}
 
-			// Proceed with original JIT instance
-			std::lock_guard lock(jmutex);
-			jit->add(cache_path + obj_name);
+	if (!objects.empty() && fpos >= info.funcs.size())
+	{
+		// Write the list of objects used by the module (if changed)
+		std::string manifest;
 
-			LOG_SUCCESS(PPU, "LLVM: Compiled module %s", obj_name);
-		});
+		for (const auto& obj_name : objects)
+		{
+			manifest += obj_name;
+			manifest += '\n';
+		}
+
+		const std::string manifest_path = cache_path + "objects.txt";
+
+		const fs::file old_manifest(manifest_path);
+
+		if ((!old_manifest || old_manifest.to_string() != manifest) && !fs::file(manifest_path, fs::rewrite).write(manifest))
+		{
+			LOG_ERROR(PPU, "LLVM: Failed to write %s (%s)", manifest_path, fs::g_tls_error);
+		}
 	}
 
-	// Join worker threads
-	for (auto& thread : jthreads)
+	// Wait for compilation
+	for (const auto& obj_name : jobjects)
 	{
-		thread.join();
+		jpool->wait(store_path + obj_name);
+
+		if (Emu.IsStopped() || !jit || !fs::is_file(store_path + obj_name))
+		{
+			continue;
+		}
+
+		std::lock_guard lock(jmutex);
+
+		if (!jit->add(store_path + obj_name))
+		{
+			// Don't keep the broken object for the next run
+			fs::remove_file(store_path + obj_name);
+			fmt::throw_exception("LLVM: Failed to load compiled module %s" HERE, obj_name);
+		}
+
+		LOG_SUCCESS(PPU, "LLVM: Compiled module %s", obj_name);
 	}
 
 	if (Emu.IsStopped() || !get_current_cpu_thread())
@@ -1667,7 +1943,7 @@ extern void ppu_initialize(const ppu_module& info)
 #endif
 }
 
-static void ppu_initialize2(jit_compiler& jit, const ppu_module& module_part, const std::string& cache_path, const std::string& obj_name)
+static void ppu_initialize2(jit_compiler& jit, const ppu_module& info, const std::vector<ppu_function>& funcs, const std::string& cache_path, const std::string& obj_name)
 {
 #ifdef LLVM_AVAILABLE
 	using namespace llvm;
@@ -1679,14 +1955,14 @@ static void ppu_initialize2(jit_compiler& jit, const ppu_module& module_part, co
 	module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
 
 	// Initialize translator
-	PPUTranslator translator(jit.get_context(), module.get(), module_part, jit.has_ssse3());
+	PPUTranslator translator(jit.get_context(), module.get(), info, funcs, jit.has_ssse3());
 
 	// Define some types
 	const auto _void = Type::getVoidTy(jit.get_context());
 	const auto _func = FunctionType::get(_void, {translator.GetContextType()->getPointerTo()}, false);
 
 	// Initialize function list
-	for (const auto& func : module_part.funcs)
+	for (const auto& func : funcs)
 	{
 		if (func.size)
 		{
@@ -1719,7 +1995,7 @@ static void ppu_initialize2(jit_compiler& jit, const ppu_module& module_part, co
 		//pm.add(createLintPass()); // Check
 
 		// Translate functions
-		for (size_t fi = 0, fmax = module_part.funcs.size(); fi < fmax; fi++)
+		for (size_t fi = 0, fmax = funcs.size(); fi < fmax; fi++)
 		{
 			if (Emu.IsStopped())
 			{
@@ -1727,10 +2003,10 @@ static void ppu_initialize2(jit_compiler& jit, const ppu_module& module_part, co
 				return;
 			}
 
-			if (module_part.funcs[fi].size)
+			if (funcs[fi].size)
 			{
 				// Translate
-				if (const auto func = translator.Translate(module_part.funcs[fi]))
+				if (const auto func = translator.Translate(funcs[fi]))
 				{
 					// Run optimization passes
 					pm.run(*func);
@@ -168,6 +168,8 @@ public:
 
 	lf_value<std::string> ppu_name; // Thread name
 
+	lv2_wait_link lv2_link; // Sleep queue links (must be the last member, see ppu cache)
+
 	be_t<u64>* get_stack_arg(s32 i, u64 align = alignof(u64));
 	void exec_task();
 	void fast_call(u32 addr, u32 rtoc);
@@ -309,7 +309,7 @@ public:
 	// Handle compilation errors
 	void CompilationError(const std::string& error);
 
-	PPUTranslator(llvm::LLVMContext& context, llvm::Module* module, const ppu_module& info, bool ssse3);
+	PPUTranslator(llvm::LLVMContext& context, llvm::Module* module, const ppu_module& info, const std::vector<ppu_function>& funcs, bool ssse3);
 	~PPUTranslator();
 
 	// Get thread context struct type
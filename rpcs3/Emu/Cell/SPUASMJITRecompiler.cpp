@@ -846,7 +846,7 @@ bool spu_recompiler::compile(u64 last_reset_count, const std::vector<u32>& func)
 
 	if (m_cache && g_cfg.core.spu_cache)
 	{
-		m_cache->add(func);
+		m_cache->add(func, m_block_size);
 	}
 
 	return true;
@@ -1580,12 +1580,27 @@ void spu_recompiler::RCHCNT(spu_opcode_t op)
 	{
 	case SPU_WrOutMbox:       return ch_cnt(SPU_OFF_64(ch_out_mbox), true);
 	case SPU_WrOutIntrMbox:   return ch_cnt(SPU_OFF_64(ch_out_intr_mbox), true);
-	case MFC_RdTagStat:       return ch_cnt(SPU_OFF_64(ch_tag_stat));
 	case MFC_RdListStallStat: return ch_cnt(SPU_OFF_64(ch_stall_stat));
 	case SPU_RdSigNotify1:    return ch_cnt(SPU_OFF_64(ch_snr1));
 	case SPU_RdSigNotify2:    return ch_cnt(SPU_OFF_64(ch_snr2));
 	case MFC_RdAtomicStat:    return ch_cnt(SPU_OFF_64(ch_atomic_stat));
 
+	case MFC_RdTagStat:
+	{
+		if (g_cfg.core.spu_async_mfc)
+		{
+			// Tag status may depend on the DMA worker
+			Label ret = c->newLabel();
+			c->mov(SPU_OFF_32(pc), m_pos);
+			c->mov(*ls, op.ra);
+			c->lea(*qw0, x86::qword_ptr(ret));
+			c->jmp(imm_ptr(spu_rchcnt));
+			c->bind(ret);
+			break;
+		}
+
+		return ch_cnt(SPU_OFF_64(ch_tag_stat));
+	}
 	case MFC_WrTagUpdate:
 	{
 		const XmmLink& vr = XmmAlloc();
@@ -2394,6 +2409,12 @@ void spu_recompiler::WRCH(spu_opcode_t op)
 	}
 	case MFC_WrTagUpdate:
 	{
+		if (g_cfg.core.spu_async_mfc)
+		{
+			// Tag status may depend on the DMA worker
+			break;
+		}
+
 		Label fail = c->newLabel();
 		Label zero = c->newLabel();
 		Label ret = c->newLabel();
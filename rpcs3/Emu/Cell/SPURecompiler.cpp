@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <mutex>
 #include <thread>
+#include <unordered_set>
 
 extern atomic_t<const char*> g_progr;
 extern atomic_t<u64> g_progr_ptotal;
@@ -23,23 +24,9 @@ const spu_decoder<spu_iname> s_spu_iname;
 
 extern u64 get_timebased_time();
 
-thread_local DECLARE(spu_runtime::workload){};
+extern const spu_decoder<spu_interpreter_precise> g_spu_interpreter_precise;
 
-thread_local DECLARE(spu_runtime::addrv){u32{0}};
-
-DECLARE(spu_runtime::tr_dispatch) = []
-{
-	// Generate a special trampoline to spu_recompiler_base::dispatch with pause instruction
-	u8* const trptr = jit_runtime::alloc(16, 16);
-	trptr[0] = 0xf3; // pause
-	trptr[1] = 0x90;
-	trptr[2] = 0xff; // jmp [rip]
-	trptr[3] = 0x25;
-	std::memset(trptr + 4, 0, 4);
-	const u64 target = reinterpret_cast<u64>(&spu_recompiler_base::dispatch);
-	std::memcpy(trptr + 8, &target, 8);
-	return reinterpret_cast<spu_function_t>(trptr);
-}();
+extern const spu_decoder<spu_interpreter_fast> g_spu_interpreter_fast;
 
 DECLARE(spu_runtime::tr_branch) = []
 {
@@ -66,68 +53,324 @@ DECLARE(spu_runtime::g_dispatcher) = []
 	return ptr;
 }();
 
+// SPU cache file magic ("SPUCACHE")
+static constexpr u64 s_spu_cache_magic = 0x5350554341434845;
+
+// SPU cache format version
+static constexpr u32 s_spu_cache_version = 3;
+
 spu_cache::spu_cache(const std::string& loc)
 	: m_file(loc, fs::read + fs::write + fs::create + fs::append)
+	, m_path(loc)
 {
+	if (m_file && m_file.size() < sizeof(file_header))
+	{
+		// Write header to the new (or broken) file
+		file_header header{};
+		header.magic = s_spu_cache_magic;
+		header.version = s_spu_cache_version;
+
+		m_file.trunc(0);
+		m_file.write(header);
+	}
 }
 
 spu_cache::~spu_cache()
 {
 }
 
-std::deque<std::vector<u32>> spu_cache::get()
+u64 spu_cache::hash(const std::vector<u32>& func)
 {
-	std::deque<std::vector<u32>> result;
+	sha1_context ctx;
+	u8 output[20];
+
+	sha1_starts(&ctx);
+	sha1_update(&ctx, reinterpret_cast<const u8*>(func.data()), func.size() * 4);
+	sha1_finish(&ctx, output);
+
+	u64 result;
+	std::memcpy(&result, output, sizeof(result));
+	return result;
+}
+
+std::vector<spu_cache::entry> spu_cache::get()
+{
+	std::vector<spu_cache::entry> result;
 
 	if (!m_file)
 	{
 		return result;
 	}
 
-	m_file.seek(0);
+	std::lock_guard lock(m_mutex);
 
-	// TODO: signal truncated or otherwise broken file
-	while (true)
+	m_index.clear();
+	m_dups = 0;
+	m_view = fs::file_view(m_file);
+
+	const u8* const base = m_view.data();
+	const u64 fsize = m_view.size();
+
+	if (!m_view || fsize < sizeof(file_header))
 	{
-		be_t<u32> size;
-		be_t<u32> addr;
-		std::vector<u32> func;
+		return result;
+	}
+
+	file_header header;
+	std::memcpy(&header, base, sizeof(header));
+
+	if (header.magic != s_spu_cache_magic || header.version != s_spu_cache_version)
+	{
+		LOG_ERROR(SPU, "SPU Cache: unsupported file, resetting (%s)", m_path);
+		m_view.close();
 
-		if (!m_file.read(size) || !m_file.read(addr))
+		header.magic = s_spu_cache_magic;
+		header.version = s_spu_cache_version;
+		header.reserved = 0;
+
+		if (!m_file.trunc(0) || m_file.write(&header, sizeof(header)) != sizeof(header))
 		{
-			break;
+			m_file.close();
 		}
 
-		func.resize(size + 1);
-		func[0] = addr;
+		return result;
+	}
+
+	u64 pos = sizeof(file_header);
+	u64 dups = 0;
+
+	// Only headers are read here, function data is accessed lazily through the mapping
+	while (pos + sizeof(entry_header) <= fsize)
+	{
+		entry_header eh;
+		std::memcpy(&eh, base + pos, sizeof(eh));
+
+		const u64 next = pos + sizeof(entry_header) + u64{eh.size} * 4;
 
-		if (m_file.read(func.data() + 1, func.size() * 4 - 4) != func.size() * 4 - 4)
+		if (!eh.size || eh.size > 0x10000 || eh.addr >= 0x40000 || eh.addr % 4 || eh.block_size > static_cast<u32>(spu_block_size_type::giga) || next > fsize)
 		{
 			break;
 		}
 
-		result.emplace_front(std::move(func));
+		const u32* const data = reinterpret_cast<const u32*>(base + pos + sizeof(entry_header));
+
+		// Equal hashes don't guarantee equal contents
+		bool dup = false;
+
+		for (auto [it, end] = m_index.equal_range(eh.hash); it != end; ++it)
+		{
+			entry_header other;
+			std::memcpy(&other, base + it->second, sizeof(other));
+
+			if (other.addr == eh.addr && other.size == eh.size && std::memcmp(base + it->second + sizeof(entry_header), data, eh.size * 4) == 0)
+			{
+				dup = true;
+				break;
+			}
+		}
+
+		if (!dup)
+		{
+			m_index.emplace(eh.hash, pos);
+			result.emplace_back(entry{eh.addr, eh.size, data, static_cast<spu_block_size_type>(u32{eh.block_size})});
+		}
+		else
+		{
+			dups++;
+		}
+
+		pos = next;
 	}
 
+	if (pos != fsize)
+	{
+		// Appending after a broken entry would make the rest of the file unreadable
+		LOG_ERROR(SPU, "SPU Cache: truncated or damaged file (0x%llx of 0x%llx bytes are valid)", pos, fsize);
+		m_view.close();
+
+		if (!m_file.trunc(pos))
+		{
+			LOG_ERROR(SPU, "SPU Cache: failed to truncate %s", m_path);
+			m_file.close();
+			m_index.clear();
+			result.clear();
+			return result;
+		}
+
+		m_view = fs::file_view(m_file);
+
+		if (!m_view)
+		{
+			m_index.clear();
+			result.clear();
+			return result;
+		}
+
+		for (auto& e : result)
+		{
+			e.data = reinterpret_cast<const u32*>(m_view.data() + (reinterpret_cast<const u8*>(e.data) - base));
+		}
+	}
+
+	if (dups)
+	{
+		LOG_WARNING(SPU, "SPU Cache: %u duplicate entries found", dups);
+		m_dups = dups;
+	}
+
+	// Most recent entries first
+	std::reverse(result.begin(), result.end());
 	return result;
 }
 
-void spu_cache::add(const std::vector<u32>& func)
+void spu_cache::add(const std::vector<u32>& func, spu_block_size_type block_size)
 {
 	if (!m_file)
 	{
 		return;
 	}
 
+	const u64 key = hash(func);
+
+	std::lock_guard lock(m_mutex);
+
+	if (!m_file)
+	{
+		return;
+	}
+
+	for (auto [it, end] = m_index.equal_range(key); it != end; ++it)
+	{
+		if (stored_at(it->second, func))
+		{
+			// Already stored
+			return;
+		}
+	}
+
 	// Allocate buffer
-	const auto buf = std::make_unique<be_t<u32>[]>(func.size() + 1);
+	const auto buf = std::make_unique<u8[]>(sizeof(entry_header) + func.size() * 4 - 4);
 
-	buf[0] = ::size32(func) - 1;
-	buf[1] = func[0];
-	std::memcpy(buf.get() + 2, func.data() + 1, func.size() * 4 - 4);
+	entry_header eh;
+	eh.size = ::size32(func) - 1;
+	eh.addr = func[0];
+	eh.hash = key;
+	eh.block_size = static_cast<u32>(block_size);
+	eh.reserved = 0;
+	std::memcpy(buf.get(), &eh, sizeof(eh));
+	std::memcpy(buf.get() + sizeof(eh), func.data() + 1, func.size() * 4 - 4);
 
 	// Append data
-	m_file.write(buf.get(), func.size() * 4 + 4);
+	const u64 pos = m_file.size();
+
+	if (m_file.write(buf.get(), sizeof(entry_header) + func.size() * 4 - 4) == sizeof(entry_header) + func.size() * 4 - 4)
+	{
+		m_index.emplace(key, pos);
+	}
+}
+
+bool spu_cache::stored_at(u64 pos, const std::vector<u32>& func) const
+{
+	// Entries appended after get() are not mapped, read them from the file
+	entry_header eh;
+
+	if (m_file.read_at(pos, &eh, sizeof(eh)) != sizeof(eh) || eh.addr != func[0] || eh.size + 1 != func.size())
+	{
+		return false;
+	}
+
+	std::vector<u32> data(eh.size);
+
+	if (m_file.read_at(pos + sizeof(eh), data.data(), eh.size * 4) != eh.size * 4)
+	{
+		return false;
+	}
+
+	return std::memcmp(data.data(), func.data() + 1, eh.size * 4) == 0;
+}
+
+bool spu_cache::compact()
+{
+	if (!m_file)
+	{
+		return false;
+	}
+
+	std::lock_guard lock(m_mutex);
+
+	const std::string tmp = m_path + ".tmp";
+
+	// Keep the original order of unique entries
+	std::vector<u64> offsets;
+	offsets.reserve(m_index.size());
+
+	for (const auto& pair : m_index)
+	{
+		offsets.push_back(pair.second);
+	}
+
+	std::sort(offsets.begin(), offsets.end());
+
+	decltype(m_index) new_index;
+	{
+		const fs::file_view view(m_file);
+
+		fs::file out(tmp, fs::rewrite);
+
+		if (!view || !out)
+		{
+			LOG_ERROR(SPU, "SPU Cache: failed to compact %s (%s)", m_path, fs::g_tls_error);
+			return false;
+		}
+
+		file_header header{};
+		header.magic = s_spu_cache_magic;
+		header.version = s_spu_cache_version;
+		out.write(header);
+
+		for (const u64 pos : offsets)
+		{
+			entry_header eh;
+			std::memcpy(&eh, view.data() + pos, sizeof(eh));
+
+			const u64 size = sizeof(entry_header) + u64{eh.size} * 4;
+
+			new_index.emplace(eh.hash, out.pos());
+
+			if (pos + size > view.size() || out.write(view.data() + pos, size) != size)
+			{
+				LOG_ERROR(SPU, "SPU Cache: failed to write %s", tmp);
+				out.close();
+				fs::remove_file(tmp);
+				return false;
+			}
+		}
+	}
+
+	// Replace the file (all mappings must be released first)
+	m_view.close();
+	m_file.close();
+
+	if (!fs::rename(tmp, m_path, true))
+	{
+		LOG_ERROR(SPU, "SPU Cache: failed to replace %s (%s)", m_path, fs::g_tls_error);
+		fs::remove_file(tmp);
+	}
+	else
+	{
+		m_index = std::move(new_index);
+		m_dups = 0;
+	}
+
+	m_file.open(m_path, fs::read + fs::write + fs::create + fs::append);
+
+	if (!m_file)
+	{
+		m_index.clear();
+		return false;
+	}
+
+	return true;
 }
 
 void spu_cache::initialize()
@@ -140,7 +383,10 @@ void spu_cache::initialize()
 	}
 
 	// SPU cache file (version + block size type)
-	const std::string loc = ppu_cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-v1-tane.dat";
+	const std::string loc = ppu_cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-v3-tane.dat";
+
+	// Entries of v2 caches don't record the block size they were analysed with
+	fs::remove_file(ppu_cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-v2-tane.dat");
 
 	auto cache = std::make_shared<spu_cache>(loc);
 
@@ -150,8 +396,55 @@ void spu_cache::initialize()
 		return;
 	}
 
-	// Read cache
+	// Import functions from the old append-only format
+	const std::string old_loc = ppu_cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-v1-tane.dat";
+
+	if (fs::file old_file{old_loc})
+	{
+		u32 count = 0;
+
+		while (true)
+		{
+			be_t<u32> size;
+			be_t<u32> addr;
+			std::vector<u32> func;
+
+			if (!old_file.read(size) || !old_file.read(addr))
+			{
+				break;
+			}
+
+			func.resize(size + 1);
+			func[0] = addr;
+
+			if (old_file.read(func.data() + 1, func.size() * 4 - 4) != func.size() * 4 - 4)
+			{
+				break;
+			}
+
+			cache->add(func, g_cfg.core.spu_block_size);
+			count++;
+		}
+
+		old_file.close();
+		fs::remove_file(old_loc);
+		LOG_NOTICE(SPU, "SPU Cache: imported %u entries from %s", count, old_loc);
+	}
+
+	// Map cache file and build the index
 	auto func_list = cache->get();
+
+	if (cache->needs_compaction())
+	{
+		if (cache->compact())
+		{
+			func_list = cache->get();
+		}
+		else
+		{
+			func_list.clear();
+		}
+	}
 	atomic_t<std::size_t> fnext{};
 	atomic_t<u8> fail_flag{0};
 
@@ -201,17 +494,20 @@ void spu_cache::initialize()
 		// Fake LS
 		std::vector<be_t<u32>> ls(0x10000);
 
+		// Function data (copied from the mapped file)
+		std::vector<u32> func;
+
 		// Build functions
 		for (std::size_t func_i = fnext++; func_i < func_list.size(); func_i = fnext++)
 		{
-			std::vector<u32>& func = func_list[func_i];
-
 			if (Emu.IsStopped() || fail_flag)
 			{
 				g_progr_pdone++;
 				continue;
 			}
 
+			func_list[func_i].get(func);
+
 			// Get data start
 			const u32 start = func[0] * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
 			const u32 size0 = ::size32(func);
@@ -222,8 +518,8 @@ void spu_cache::initialize()
 				ls[pos / 4] = se_storage<u32>::swap(func[i]);
 			}
 
-			// Call analyser
-			const std::vector<u32>& func2 = compiler->analyse(ls.data(), func[0]);
+			// Call analyser (with the block size the entry was recorded with, profile doesn't apply)
+			const std::vector<u32>& func2 = compiler->analyse(ls.data(), func[0], func_list[func_i].block_size);
 
 			if (func2.size() != size0)
 			{
@@ -288,10 +584,166 @@ void spu_cache::initialize()
 	});
 }
 
+// SPU profile file magic ("SPUPROF\0")
+static constexpr u64 s_spu_profile_magic = 0x53505550524f4600;
+
+spu_profile::spu_profile()
+{
+	const std::string ppu_cache = Emu.PPUCache();
+
+	if (ppu_cache.empty())
+	{
+		return;
+	}
+
+	m_path = ppu_cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-profile.dat";
+
+	const fs::file_view view(fs::file{m_path});
+
+	file_header header{};
+
+	if (view.size() >= sizeof(header))
+	{
+		std::memcpy(&header, view.data(), sizeof(header));
+	}
+
+	if (header.magic != s_spu_profile_magic || header.version != 1 || view.size() < sizeof(header) + u64{header.count} * sizeof(entry))
+	{
+		if (view)
+		{
+			LOG_ERROR(SPU, "SPU Profile: unsupported file (%s)", m_path);
+		}
+
+		return;
+	}
+
+	// Execution counts by entry point
+	std::vector<std::pair<u64, u32>> totals;
+	std::unordered_map<u32, u64, value_hash<u32, 2>> by_addr;
+	u64 total = 0;
+
+	for (u32 i = 0; i < header.count; i++)
+	{
+		entry e;
+		std::memcpy(&e, view.data() + sizeof(header) + i * sizeof(entry), sizeof(entry));
+
+		if (e.addr >= 0x40000 || e.addr % 4)
+		{
+			continue;
+		}
+
+		// Halve old counts so the profile adapts over several runs
+		auto& c = m_counters[e.hash];
+		c.addr = e.addr;
+		c.size = e.size;
+		c.count = e.count / 2;
+
+		by_addr[e.addr] += e.count;
+		total += e.count;
+	}
+
+	for (const auto& pair : by_addr)
+	{
+		totals.emplace_back(pair.second, pair.first);
+	}
+
+	std::sort(totals.begin(), totals.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+	// Select the smallest set of functions covering 90% of executions (limited)
+	u64 covered = 0;
+
+	for (std::size_t i = 0; i < totals.size() && i < 64 && covered < total - total / 10; i++)
+	{
+		m_hot.set(totals[i].second / 4);
+		covered += totals[i].first;
+	}
+
+	LOG_NOTICE(SPU, "SPU Profile: loaded %u functions (%u hot)", m_counters.size(), m_hot.count());
+}
+
+spu_profile::~spu_profile()
+{
+	if (m_path.empty() || !g_cfg.core.spu_profiling)
+	{
+		return;
+	}
+
+	std::vector<entry> entries;
+
+	for (const auto& pair : m_counters)
+	{
+		if (const u64 count = pair.second.count)
+		{
+			entry e;
+			e.hash = pair.first;
+			e.addr = pair.second.addr;
+			e.size = pair.second.size;
+			e.count = count;
+			entries.emplace_back(e);
+		}
+	}
+
+	file_header header;
+	header.magic = s_spu_profile_magic;
+	header.version = 1;
+	header.count = ::size32(entries);
+
+	// Write the new file and replace the old one
+	fs::file out(m_path + ".tmp", fs::rewrite);
+
+	if (!out || !out.write(header) || out.write(entries.data(), entries.size() * sizeof(entry)) != entries.size() * sizeof(entry))
+	{
+		LOG_ERROR(SPU, "SPU Profile: failed to write %s (%s)", m_path, fs::g_tls_error);
+		return;
+	}
+
+	out.close();
+
+	if (!fs::rename(m_path + ".tmp", m_path, true))
+	{
+		LOG_ERROR(SPU, "SPU Profile: failed to rename %s (%s)", m_path, fs::g_tls_error);
+		return;
+	}
+
+	LOG_NOTICE(SPU, "SPU Profile: saved %u functions", entries.size());
+}
+
+void spu_profile::add(u64 hash, u32 addr, u32 size)
+{
+	{
+		reader_lock lock(m_mutex);
+
+		if (m_counters.count(hash))
+		{
+			return;
+		}
+	}
+
+	std::lock_guard lock(m_mutex);
+
+	auto& c = m_counters[hash];
+	c.addr = addr;
+	c.size = size;
+}
+
+atomic_t<u64>* spu_profile::find(u64 hash)
+{
+	reader_lock lock(m_mutex);
+
+	const auto found = m_counters.find(hash);
+
+	if (found == m_counters.end())
+	{
+		return nullptr;
+	}
+
+	return &found->second.count;
+}
+
 spu_runtime::spu_runtime()
 {
-	// Initialize "empty" block
-	m_map[std::vector<u32>()] = &spu_recompiler_base::dispatch;
+	// Initialize function index (empty)
+	m_index = std::make_unique<atomic_t<func_entry*>[]>(0x10000);
 
 	// Clear LLVM output
 	m_cache_path = Emu.PPUCache();
@@ -303,11 +755,25 @@ spu_runtime::spu_runtime()
 		fs::file(m_cache_path + "spu.log", fs::rewrite);
 	}
 
-	workload.reserve(250);
-
 	LOG_SUCCESS(SPU, "SPU Recompiler Runtime initialized...");
 }
 
+spu_runtime::~spu_runtime()
+{
+	clear_index();
+}
+
+void spu_runtime::clear_index()
+{
+	for (u32 i = 0; i < 0x10000; i++)
+	{
+		for (func_entry* e = m_index[i].exchange(nullptr); e;)
+		{
+			delete std::exchange(e, e->next);
+		}
+	}
+}
+
 bool spu_runtime::add(u64 last_reset_count, void* _where, spu_function_t compiled)
 {
 	writer_lock lock(*this);
@@ -319,340 +785,245 @@ bool spu_runtime::add(u64 last_reset_count, void* _where, spu_function_t compile
 	}
 
 	// Use opaque pointer
-	auto& where = *static_cast<decltype(m_map)::value_type*>(_where);
+	auto& where = *static_cast<func_entry*>(_where);
 
 	// Function info
-	const std::vector<u32>& func = where.first;
+	const std::vector<u32>& func = where.data;
 
 	//
 	const u32 start = func[0] * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
 
-	// Set pointer to the compiled function
-	where.second = compiled;
+	// Set pointer to the compiled function (notify waiters in lock destructor)
+	where.compiled = compiled;
+	lock.notify = true;
 
-	// Generate a dispatcher (übertrampoline)
-	addrv[0] = func[0];
-	const auto beg = m_map.lower_bound(addrv);
-	addrv[0] += 4;
-	const auto _end = m_map.lower_bound(addrv);
-	const u32 size0 = std::distance(beg, _end);
+	// Find the indices distinguishing the new function from all functions already linked at this address
+	std::vector<u32> indices;
+	bool full_check = false;
 
-	if (size0 == 1)
-	{
-		g_dispatcher[func[0] / 4] = compiled;
-	}
-	else
+	for (auto e = m_index[func[0] / 4].load(); e; e = e->next)
 	{
-		// Allocate some writable executable memory
-		u8* const wxptr = jit_runtime::alloc(size0 * 20, 16);
-
-		if (!wxptr)
+		if (e == &where || !e->linked)
 		{
-			return false;
+			continue;
 		}
 
-		// Raw assembly pointer
-		u8* raw = wxptr;
+		u32 found = 0;
 
-		// Write jump instruction with rel32 immediate
-		auto make_jump = [&](u8 op, auto target)
+		for (u32 i = 1; i < std::min(func.size(), e->data.size()); i++)
 		{
-			verify("Asm overflow" HERE), raw + 6 <= wxptr + size0 * 20;
+			if (func[i] && e->data[i] && func[i] != e->data[i])
+			{
+				found = i;
+				break;
+			}
+		}
 
-			// Fallback to dispatch if no target
-			const u64 taddr = target ? reinterpret_cast<u64>(target) : reinterpret_cast<u64>(tr_dispatch);
+		if (!found)
+		{
+			// Cannot distinguish (function with holes or a prefix of another one): compare everything
+			full_check = true;
+			break;
+		}
 
-			// Compute the distance
-			const s64 rel = taddr - reinterpret_cast<u64>(raw) - (op != 0xe9 ? 6 : 5);
+		if (std::find(indices.begin(), indices.end(), found) == indices.end())
+		{
+			indices.push_back(found);
+		}
+	}
 
-			verify(HERE), rel >= INT32_MIN, rel <= INT32_MAX;
+	if (full_check)
+	{
+		indices.clear();
 
-			if (op != 0xe9)
+		for (u32 i = 1; i < func.size(); i++)
+		{
+			if (func[i])
 			{
-				// First jcc byte
-				*raw++ = 0x0f;
-				verify(HERE), (op >> 4) == 0x8;
+				indices.push_back(i);
 			}
+		}
+	}
 
-			*raw++ = op;
-
-			const s32 r32 = static_cast<s32>(rel);
-
-			std::memcpy(raw, &r32, 4);
-			raw += 4;
-		};
-
-		workload.clear();
-		workload.reserve(size0);
-		workload.emplace_back();
-		workload.back().size  = size0;
-		workload.back().level = 1;
-		workload.back().from  = 0;
-		workload.back().rel32 = 0;
-		workload.back().beg   = beg;
-		workload.back().end   = _end;
+	where.linked = true;
 
-		for (std::size_t i = 0; i < workload.size(); i++)
-		{
-			// Get copy of the workload info
-			auto w = workload[i];
+	if (indices.empty())
+	{
+		// First function at this address
+		g_dispatcher[func[0] / 4] = compiled;
+		return true;
+	}
 
-			// Split range in two parts
-			auto it = w.beg;
-			auto it2 = w.beg;
-			u32 size1 = w.size / 2;
-			u32 size2 = w.size - size1;
-			std::advance(it2, w.size / 2);
+	std::sort(indices.begin(), indices.end());
 
-			while (verify("spu_runtime::work::level overflow" HERE, w.level))
-			{
-				it = it2;
-				size1 = w.size - size2;
+	// Build a trampoline checking the new function, otherwise falling back to the previous dispatcher
+	// Each index: mov eax, [ls + imm32] (6), cmp eax, imm32 (5), jne rel32 (6); then two jmp rel32 (5)
+	const u32 size0 = ::size32(indices) * 17 + 10;
 
-				if (w.level >= w.beg->first.size())
-				{
-					// Cannot split: smallest function is a prefix of bigger ones (TODO)
-					break;
-				}
+	// Allocate some writable executable memory
+	u8* const wxptr = jit_runtime::alloc(size0, 16);
 
-				const u32 x1 = w.beg->first.at(w.level);
+	if (!wxptr)
+	{
+		return false;
+	}
 
-				if (!x1)
-				{
-					// Cannot split: some functions contain holes at this level
-					w.level++;
-					continue;
-				}
+	// Raw assembly pointer
+	u8* raw = wxptr;
 
-				// Adjust ranges (forward)
-				while (it != w.end && x1 == it->first.at(w.level))
-				{
-					it++;
-					size1++;
-				}
+	// Write jump instruction with rel32 immediate
+	auto make_jump = [&](u8 op, auto target)
+	{
+		verify("Asm overflow" HERE), raw + (op != 0xe9 ? 6 : 5) <= wxptr + size0;
 
-				if (it == w.end)
-				{
-					// Cannot split: words are identical within the range at this level
-					w.level++;
-				}
-				else
-				{
-					size2 = w.size - size1;
-					break;
-				}
-			}
+		// Compute the distance
+		const s64 rel = reinterpret_cast<u64>(target) - reinterpret_cast<u64>(raw) - (op != 0xe9 ? 6 : 5);
 
-			if (w.rel32)
-			{
-				// Patch rel32 linking it to the current location if necessary
-				const s32 r32 = ::narrow<s32>(raw - w.rel32, HERE);
-				std::memcpy(w.rel32 - 4, &r32, 4);
-			}
+		verify(HERE), rel >= INT32_MIN, rel <= INT32_MAX;
 
-			if (w.level >= w.beg->first.size())
-			{
-				// If functions cannot be compared, assume smallest function
-				LOG_ERROR(SPU, "Trampoline simplified at 0x%x (level=%u)", func[0], w.level);
-				make_jump(0xe9, w.beg->second); // jmp rel32
-				continue;
-			}
+		if (op != 0xe9)
+		{
+			// First jcc byte
+			*raw++ = 0x0f;
+			verify(HERE), (op >> 4) == 0x8;
+		}
 
-			// Value for comparison
-			const u32 x = it->first.at(w.level);
+		*raw++ = op;
 
-			// Adjust ranges (backward)
-			while (true)
-			{
-				it--;
+		const s32 r32 = static_cast<s32>(rel);
 
-				if (it->first.at(w.level) != x)
-				{
-					it++;
-					break;
-				}
+		std::memcpy(raw, &r32, 4);
+		raw += 4;
+	};
 
-				verify(HERE), it != w.beg;
-				size1--;
-				size2++;
-			}
+	// Previous dispatcher (linked functions verify their code and fall back to dispatch themselves)
+	const spu_function_t old = g_dispatcher[func[0] / 4];
 
-			// Emit 32-bit comparison: cmp [ls+addr], imm32
-			verify("Asm overflow" HERE), raw + 11 <= wxptr + size0 * 20;
+	// Location of the rel32 of each failure jump
+	std::vector<u8*> fails;
 
-			if (w.from != w.level)
-			{
-				// If necessary (level has advanced), emit load: mov eax, [ls + addr]
+	for (const u32 index : indices)
+	{
+		// Emit load: mov eax, [ls + addr]
 #ifdef _WIN32
-				*raw++ = 0x8b;
-				*raw++ = 0x82; // ls = rdx
+		*raw++ = 0x8b;
+		*raw++ = 0x82; // ls = rdx
 #else
-				*raw++ = 0x8b;
-				*raw++ = 0x86; // ls = rsi
+		*raw++ = 0x8b;
+		*raw++ = 0x86; // ls = rsi
 #endif
-				const u32 cmp_lsa = start + (w.level - 1) * 4;
-				std::memcpy(raw, &cmp_lsa, 4);
-				raw += 4;
-			}
-
-			// Emit comparison: cmp eax, imm32
-			*raw++ = 0x3d;
-			std::memcpy(raw, &x, 4);
-			raw += 4;
+		const u32 cmp_lsa = start + (index - 1) * 4;
+		std::memcpy(raw, &cmp_lsa, 4);
+		raw += 4;
 
-			// Low subrange target
-			if (size1 == 1)
-			{
-				make_jump(0x82, w.beg->second); // jb rel32
-			}
-			else
-			{
-				make_jump(0x82, raw); // jb rel32 (stub)
-				auto& to = workload.emplace_back(w);
-				to.end   = it;
-				to.size  = size1;
-				to.rel32 = raw;
-				to.from  = w.level;
-			}
-
-			// Second subrange target
-			if (size2 == 1)
-			{
-				make_jump(0xe9, it->second); // jmp rel32
-			}
-			else
-			{
-				it2 = it;
+		// Emit comparison: cmp eax, imm32
+		*raw++ = 0x3d;
+		std::memcpy(raw, &func[index], 4);
+		raw += 4;
 
-				// Select additional midrange for equality comparison
-				while (it2 != w.end && it2->first.at(w.level) == x)
-				{
-					size2--;
-					it2++;
-				}
+		// jne rel32 (stub)
+		make_jump(0x85, raw);
+		fails.push_back(raw);
+	}
 
-				if (it2 != w.end)
-				{
-					// High subrange target
-					if (size2 == 1)
-					{
-						make_jump(0x87, it2->second); // ja rel32
-					}
-					else
-					{
-						make_jump(0x87, raw); // ja rel32 (stub)
-						auto& to = workload.emplace_back(w);
-						to.beg   = it2;
-						to.size  = size2;
-						to.rel32 = raw;
-						to.from  = w.level;
-					}
+	// All words match
+	make_jump(0xe9, compiled);
 
-					const u32 size3 = w.size - size1 - size2;
+	// Patch failure jumps
+	for (u8* rel32 : fails)
+	{
+		const s32 r32 = ::narrow<s32>(raw - rel32, HERE);
+		std::memcpy(rel32 - 4, &r32, 4);
+	}
 
-					if (size3 == 1)
-					{
-						make_jump(0xe9, it->second); // jmp rel32
-					}
-					else
-					{
-						make_jump(0xe9, raw); // jmp rel32 (stub)
-						auto& to = workload.emplace_back(w);
-						to.beg   = it;
-						to.end   = it2;
-						to.size  = size3;
-						to.rel32 = raw;
-						to.from  = w.level;
-					}
-				}
-				else
-				{
-					make_jump(0xe9, raw); // jmp rel32 (stub)
-					auto& to = workload.emplace_back(w);
-					to.beg   = it;
-					to.size  = w.size - size1;
-					to.rel32 = raw;
-					to.from  = w.level;
-				}
-			}
-		}
+	make_jump(0xe9, old);
 
-		workload.clear();
-		g_dispatcher[func[0] / 4] = reinterpret_cast<spu_function_t>(reinterpret_cast<u64>(wxptr));
-	}
+	// Self-check of the size computation (runs for every function linked at an occupied address)
+	verify("Asm size" HERE), raw == wxptr + size0;
 
-	// Notify in lock destructor
-	lock.notify = true;
+	g_dispatcher[func[0] / 4] = reinterpret_cast<spu_function_t>(wxptr);
 	return true;
 }
 
 void* spu_runtime::find(u64 last_reset_count, const std::vector<u32>& func)
 {
-	writer_lock lock(*this);
-
 	// Check reset count
 	if (last_reset_count != m_reset_count)
 	{
 		return nullptr;
 	}
 
-	// Try to find existing function, register new one if necessary
-	const auto result = m_map.try_emplace(func, nullptr);
+	const u64 hash = spu_cache::hash(func);
 
-	// Pointer to the value in the map (pair)
-	const auto fn_location = &*result.first;
+	auto& head = m_index[func[0] / 4];
 
-	if (fn_location->second)
-	{
-		// Already compiled
-		return g_dispatcher;
-	}
-	else if (!result.second)
+	std::unique_ptr<func_entry> fresh;
+
+	while (true)
 	{
-		// Wait if already in progress
-		while (!fn_location->second)
+		func_entry* const first = head.load();
+
+		// Try to find existing function
+		for (auto e = first; e; e = e->next)
 		{
-			m_cond.wait(m_mutex);
+			if (e->hash != hash || e->data != func)
+			{
+				continue;
+			}
+
+			if (e->compiled)
+			{
+				// Already compiled
+				return g_dispatcher;
+			}
 
-			// If reset count changed, fn_location is invalidated; also requires return
-			if (last_reset_count != m_reset_count)
+			writer_lock lock(*this);
+
+			// Wait if already in progress (if reset count changed, e is invalidated; also requires return)
+			while (last_reset_count == m_reset_count && !e->compiled)
 			{
-				return nullptr;
+				m_cond.wait(m_mutex);
 			}
+
+			return last_reset_count == m_reset_count ? g_dispatcher : nullptr;
 		}
 
-		return g_dispatcher;
-	}
+		// Register new function
+		if (!fresh)
+		{
+			fresh = std::make_unique<func_entry>();
+			fresh->data = func;
+			fresh->hash = hash;
+		}
+
+		fresh->next = first;
 
-	// Return location to compile and use in add()
-	return fn_location;
+		if (head.compare_and_swap_test(first, fresh.get()))
+		{
+			// Return location to compile and use in add()
+			return fresh.release();
+		}
+	}
 }
 
 spu_function_t spu_runtime::find(const se_t<u32, false>* ls, u32 addr) const
 {
-	const u64 reset_count = m_reset_count;
-
-	reader_lock lock(*this);
+	const u32 start = addr * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
 
-	if (reset_count != m_reset_count)
+	for (auto e = m_index[addr / 4].load(); e; e = e->next)
 	{
-		return nullptr;
-	}
-
-	const u32 start = addr * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
+		const spu_function_t fn = e->compiled;
 
-	addrv[0] = addr;
-	const auto beg = m_map.lower_bound(addrv);
-	addrv[0] += 4;
-	const auto _end = m_map.lower_bound(addrv);
+		if (!fn)
+		{
+			continue;
+		}
 
-	for (auto it = beg; it != _end; ++it)
-	{
 		bool bad = false;
 
-		for (u32 i = 1; i < it->first.size(); ++i)
+		for (u32 i = 1; i < e->data.size(); ++i)
 		{
-			const u32 x = it->first[i];
+			const u32 x = e->data[i];
 			const u32 y = ls[start / 4 + i - 1];
 
 			if (x && x != y)
@@ -664,7 +1035,7 @@ spu_function_t spu_runtime::find(const se_t<u32, false>* ls, u32 addr) const
 
 		if (!bad)
 		{
-			return it->second;
+			return fn;
 		}
 	}
 
@@ -729,15 +1100,18 @@ u64 spu_runtime::reset(std::size_t last_reset_count)
 		}
 	});
 
-	// Reset function map (may take some time)
-	m_map.clear();
-
-	// Wait for threads to catch on jit_return flag
+	// Wait for threads to catch on jit_return flag (nobody can access the function index after that)
 	while (m_passive_locks)
 	{
 		busy_wait();
 	}
 
+	// Reset function index (may take some time)
+	clear_index();
+
+	// Wake up threads waiting for compilation
+	lock.notify = true;
+
 	// Reinitialize (TODO)
 	jit_runtime::finalize();
 	jit_runtime::initialize();
@@ -756,7 +1130,132 @@ void spu_runtime::handle_return(spu_thread* _spu)
 	_spu->state -= cpu_flag::jit_return;
 }
 
+spu_compile_queue::spu_compile_queue()
+{
+	const u32 count = std::min<u32>(static_cast<u32>(g_cfg.core.spu_llvm_workers), std::thread::hardware_concurrency());
+
+	for (u32 i = 0; i < count; i++)
+	{
+		m_workers.emplace_back("SPU LLVM Worker " + std::to_string(i), [this]{ work(); });
+	}
+
+	LOG_NOTICE(SPU, "SPU tiered compilation enabled (%u workers)", count);
+}
+
+spu_compile_queue::~spu_compile_queue()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_cond.notify_all();
+
+	// Join worker threads
+	m_workers.clear();
+}
+
+void spu_compile_queue::work()
+{
+	// Created on first use to avoid accessing fxm from the constructor
+	std::unique_ptr<spu_recompiler_base> compiler;
+
+	// Fake LS (the compiler requires the analyser state for the function)
+	std::vector<be_t<u32>> ls(0x10000);
+
+	while (true)
+	{
+		job next;
+
+		{
+			std::lock_guard lock(m_mutex);
+
+			while (m_jobs.empty() && !m_stop && !Emu.IsStopped())
+			{
+				m_cond.wait(m_mutex, 10000);
+			}
+
+			if (m_stop || Emu.IsStopped())
+			{
+				break;
+			}
+
+			next = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		if (!compiler)
+		{
+			compiler = spu_recompiler_base::make_llvm_recompiler();
+			compiler->init();
+
+			// Workers compile directly (also avoids circular reference)
+			compiler->m_queue.reset();
+		}
+
+		{
+			// Register SPU runtime user only for the duration of compilation (don't block reset())
+			spu_runtime::passive_lock _passive_lock(compiler->get_runtime());
+
+			// Initialize LS with function data only
+			const u32 start = next.func[0] * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
+
+			for (u32 i = 1, pos = start; i < next.func.size(); i++, pos += 4)
+			{
+				ls[pos / 4] = se_storage<u32>::swap(next.func[i]);
+			}
+
+			compiler->analyse(ls.data(), next.func[0]);
+			compiler->make_function(next.func);
+
+			// Clear fake LS
+			std::memset(ls.data(), 0, 0x40000);
+		}
+
+		// Allow queuing the code at this location again (it's compiled or may have been modified)
+		std::lock_guard lock(m_mutex);
+		m_pending.erase(next.key);
+	}
+}
+
+bool spu_compile_queue::is_pending(u64 key)
+{
+	reader_lock lock(m_mutex);
+	return m_pending.count(key) != 0;
+}
+
+bool spu_compile_queue::push(u64 key, const std::vector<u32>& func)
+{
+	{
+		std::lock_guard lock(m_mutex);
+
+		if (m_stop || !m_pending.emplace(key).second)
+		{
+			return false;
+		}
+
+		m_jobs.push_back({key, func});
+	}
+
+	m_cond.notify_one();
+	return true;
+}
+
+u64 spu_compile_queue::make_key(const be_t<u32>* ls, u32 addr)
+{
+	// Entry point and the first instructions (exact match isn't required, collisions only delay compilation)
+	u64 key = addr;
+
+	for (u32 i = 0, pos = addr / 4; i < 8; i++, pos = (pos + 1) % 0x10000)
+	{
+		key = (key ^ ls[pos]) * 0x100000001b3;
+	}
+
+	return key;
+}
+
 spu_recompiler_base::spu_recompiler_base()
+	: m_block_size(g_cfg.core.spu_block_size)
 {
 	result.reserve(8192);
 }
@@ -808,6 +1307,24 @@ void spu_recompiler_base::dispatch(spu_thread& spu, void*, u8* rip)
 		return;
 	}
 
+	// Tiered mode: queue the function for background compilation and interpret it meanwhile
+	if (const auto queue = spu.jit->m_queue.get())
+	{
+		// Don't compile from the middle of a block where the interpreter was interrupted
+		if (spu.pc != spu.interp_stop_pc)
+		{
+			const u64 key = spu_compile_queue::make_key(spu._ptr<u32>(0), spu.pc);
+
+			if (!queue->is_pending(key))
+			{
+				queue->push(key, spu.jit->analyse(spu._ptr<u32>(0), spu.pc));
+			}
+		}
+
+		interpret(spu);
+		return;
+	}
+
 	// Compile
 	spu.jit->make_function(spu.jit->analyse(spu._ptr<u32>(0), spu.pc));
 
@@ -823,6 +1340,50 @@ void spu_recompiler_base::dispatch(spu_thread& spu, void*, u8* rip)
 	}
 }
 
+void spu_recompiler_base::interpret(spu_thread& spu)
+{
+	const auto& table = g_cfg.core.spu_llvm_workers_precise ? g_spu_interpreter_precise.get_table() : g_spu_interpreter_fast.get_table();
+
+	const auto ls = spu._ptr<const be_t<u32>>(0);
+
+	spu.interp_stop_pc = -1;
+
+	// Limit the number of instructions to return to the dispatcher periodically
+	for (u32 i = 0; i < 1024; i++)
+	{
+		const u32 pc = spu.pc;
+		const u32 op = ls[pc / 4];
+
+		if (!table[spu_decode(op)](spu, {op}))
+		{
+			if (spu.pc == pc && spu.state)
+			{
+				// Stopped at the instruction
+				spu.interp_stop_pc = pc;
+			}
+
+			// Branch taken or stopped
+			return;
+		}
+
+		spu.pc += 4;
+
+		if (spu_runtime::g_dispatcher[spu.pc / 4] != &dispatch)
+		{
+			// Continue in compiled code
+			return;
+		}
+
+		if (UNLIKELY(spu.state))
+		{
+			break;
+		}
+	}
+
+	// Handle state or return to the dispatcher periodically, resume interpretation afterwards
+	spu.interp_stop_pc = spu.pc;
+}
+
 void spu_recompiler_base::branch(spu_thread& spu, void*, u8* rip)
 {
 	// Find function
@@ -871,8 +1432,27 @@ void spu_recompiler_base::branch(spu_thread& spu, void*, u8* rip)
 	atomic_storage<u64>::release(*reinterpret_cast<u64*>(rip), result);
 }
 
+spu_block_size_type spu_recompiler_base::get_block_size(u32 entry_point) const
+{
+	// Giga mode is never selected here because it uses different function data layout
+	if (m_profile && g_cfg.core.spu_block_size == spu_block_size_type::safe && m_profile->is_hot(entry_point))
+	{
+		return spu_block_size_type::mega;
+	}
+
+	return g_cfg.core.spu_block_size;
+}
+
 const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 entry_point)
 {
+	// Select block size for the new function
+	return analyse(ls, entry_point, get_block_size(entry_point));
+}
+
+const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 entry_point, spu_block_size_type block_size)
+{
+	m_block_size = block_size;
+
 	// Result: addr + raw instruction data
 	result.clear();
 	result.push_back(entry_point);
@@ -917,7 +1497,7 @@ const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 en
 	u32 lsa = entry_point;
 	u32 limit = 0x40000;
 
-	if (g_cfg.core.spu_block_size == spu_block_size_type::giga)
+	if (m_block_size == spu_block_size_type::giga)
 	{
 		// In Giga mode, all data starts from the address 0
 		lsa = 0;
@@ -1003,7 +1583,7 @@ const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 en
 				continue;
 			}
 
-			if (g_cfg.core.spu_block_size == spu_block_size_type::safe)
+			if (m_block_size == spu_block_size_type::safe)
 			{
 				// Stop on special instructions (TODO)
 				m_targets[pos];
@@ -1098,7 +1678,7 @@ const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 en
 					}
 				}
 
-				if (sl && g_cfg.core.spu_block_size == spu_block_size_type::giga)
+				if (sl && m_block_size == spu_block_size_type::giga)
 				{
 					if (sync)
 					{
@@ -1120,14 +1700,14 @@ const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 en
 					limit = std::min<u32>(limit, target);
 				}
 
-				if (sl && g_cfg.core.spu_block_size != spu_block_size_type::safe)
+				if (sl && m_block_size != spu_block_size_type::safe)
 				{
 					m_entry_info[pos / 4 + 1] = true;
 					m_targets[pos].push_back(pos + 4);
 					add_block(pos + 4);
 				}
 			}
-			else if (type == spu_itype::BI && g_cfg.core.spu_block_size != spu_block_size_type::safe && !op.d && !op.e && !sync)
+			else if (type == spu_itype::BI && m_block_size != spu_block_size_type::safe && !op.d && !op.e && !sync)
 			{
 				// Analyse jump table (TODO)
 				std::basic_string<u32> jt_abs;
@@ -1267,7 +1847,7 @@ const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 en
 
 			if (type == spu_itype::BI || sl)
 			{
-				if (type == spu_itype::BI || g_cfg.core.spu_block_size == spu_block_size_type::safe)
+				if (type == spu_itype::BI || m_block_size == spu_block_size_type::safe)
 				{
 					m_targets[pos];
 				}
@@ -1310,21 +1890,21 @@ const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 en
 
 			m_targets[pos].push_back(target);
 
-			if (g_cfg.core.spu_block_size != spu_block_size_type::safe)
+			if (m_block_size != spu_block_size_type::safe)
 			{
 				m_entry_info[pos / 4 + 1] = true;
 				m_targets[pos].push_back(pos + 4);
 				add_block(pos + 4);
 			}
 
-			if (g_cfg.core.spu_block_size == spu_block_size_type::giga && !sync)
+			if (m_block_size == spu_block_size_type::giga && !sync)
 			{
 				m_entry_info[target / 4] = true;
 				add_block(target);
 			}
 			else
 			{
-				if (g_cfg.core.spu_block_size == spu_block_size_type::giga)
+				if (m_block_size == spu_block_size_type::giga)
 				{
 					LOG_NOTICE(SPU, "[0x%x] At 0x%x: ignoring fixed call to 0x%x (SYNC)", result[0], pos, target);
 				}
@@ -1702,7 +2282,7 @@ const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 en
 		}
 	}
 
-	while (g_cfg.core.spu_block_size != spu_block_size_type::giga || limit < 0x40000)
+	while (m_block_size != spu_block_size_type::giga || limit < 0x40000)
 	{
 		const u32 initial_size = result.size();
 
@@ -1805,7 +2385,7 @@ const std::vector<u32>& spu_recompiler_base::analyse(const be_t<u32>* ls, u32 en
 					continue;
 				}
 
-				if (g_cfg.core.spu_block_size != spu_block_size_type::giga)
+				if (m_block_size != spu_block_size_type::giga)
 				{
 					result.resize(valid_size + 1);
 					break;
@@ -2087,6 +2667,21 @@ class spu_llvm_recompiler : public spu_recompiler_base, public cpu_translator
 	// Global variable (function table)
 	llvm::GlobalVariable* m_function_table{};
 
+	// Object cache location (empty if disabled)
+	std::string m_obj_path;
+
+	// Link cells allocated in JIT memory (symbol name -> cell address)
+	std::unordered_map<std::string, u64> m_link_cells;
+
+	// Reset count m_link_cells was filled at
+	u64 m_link_reset = -1;
+
+	// Entry symbols defined in the JIT engine (they can't be removed, even by spu_runtime::reset)
+	std::unordered_set<std::string> m_defined;
+
+	// Counter for unique names of rebuilt functions
+	u32 m_rebuilds = 0;
+
 	llvm::MDNode* m_md_unlikely;
 	llvm::MDNode* m_md_likely;
 
@@ -2170,7 +2765,7 @@ class spu_llvm_recompiler : public spu_recompiler_base, public cpu_translator
 		{
 			m_function_queue.push_back(addr);
 
-			if (m_block && g_cfg.core.spu_block_size != spu_block_size_type::safe)
+			if (m_block && m_block_size != spu_block_size_type::safe)
 			{
 				// Initialize constants for non-volatile registers (TODO)
 				auto& regs = empl.first->second.reg;
@@ -2203,7 +2798,110 @@ class spu_llvm_recompiler : public spu_recompiler_base, public cpu_translator
 		m_blocks.clear();
 		m_block_queue.clear();
 		m_ir->SetInsertPoint(llvm::BasicBlock::Create(m_context, "", m_function));
-		m_memptr = m_ir->CreateIntToPtr(m_ir->getInt64((u64)vm::g_base_addr), get_type<u8*>());
+		m_memptr = get_extern("spu_vm_base", get_type<u8*>());
+	}
+
+	// Load external pointer (through the link cell, see resolve())
+	llvm::Value* get_extern(const std::string& name, llvm::Type* type)
+	{
+		const auto cell = m_module->getOrInsertGlobal(name, get_type<u8*>());
+		const auto load = m_ir->CreateLoad(cell);
+		load->setMetadata(llvm::LLVMContext::MD_invariant_load, llvm::MDNode::get(m_context, {}));
+		return m_ir->CreateBitCast(load, type);
+	}
+
+	// External symbols used by the compiled code (addresses may differ between runs)
+	static const std::unordered_map<std::string, u64>& get_link_table()
+	{
+		static const std::unordered_map<std::string, u64> s_table
+		{
+			{"spu_vm_base", reinterpret_cast<u64>(vm::g_base_addr)},
+			{"spu_dispatcher", reinterpret_cast<u64>(spu_runtime::g_dispatcher)},
+			{"spu_dispatch", reinterpret_cast<u64>(&spu_recompiler_base::dispatch)},
+			{"spu_check_state", reinterpret_cast<u64>(&exec_check_state)},
+			{"spu_check_interrupts", reinterpret_cast<u64>(&exec_check_interrupts)},
+			{"spu_unk", reinterpret_cast<u64>(&exec_unk)},
+			{"spu_stop", reinterpret_cast<u64>(&exec_stop)},
+			{"spu_rdch", reinterpret_cast<u64>(&exec_rdch)},
+			{"spu_read_in_mbox", reinterpret_cast<u64>(&exec_read_in_mbox)},
+			{"spu_read_dec", reinterpret_cast<u64>(&exec_read_dec)},
+			{"spu_read_events", reinterpret_cast<u64>(&exec_read_events)},
+			{"spu_get_events", reinterpret_cast<u64>(&exec_get_events)},
+			{"spu_rchcnt", reinterpret_cast<u64>(&exec_rchcnt)},
+			{"spu_mfc_cmd", reinterpret_cast<u64>(&exec_mfc_cmd)},
+			{"spu_list_unstall", reinterpret_cast<u64>(&exec_list_unstall)},
+			{"spu_wrch", reinterpret_cast<u64>(&exec_wrch)},
+			{"get_timebased_time", reinterpret_cast<u64>(&get_timebased_time)},
+		};
+
+		return s_table;
+	}
+
+	// Resolve external symbol to the link cell (called by the JIT linker)
+	u64 resolve(const std::string& name)
+	{
+		u64 value = 0;
+
+		if (name.compare(0, 7, "spu-pp-") == 0)
+		{
+			// Branch patchpoints are created for each object (spu-pp-<target>)
+			const auto ppptr = m_spurt->make_branch_patchpoint(static_cast<u32>(std::stoul(name.substr(7), nullptr, 16)));
+			value = ppptr ? reinterpret_cast<u64>(ppptr) : reinterpret_cast<u64>(&spu_recompiler_base::dispatch);
+		}
+		else if (name.compare(0, 9, "spu-prof-") == 0)
+		{
+			// Profile counters (spu-prof-<content hash>)
+			const auto counter = m_profile ? m_profile->find(std::stoull(name.substr(9), nullptr, 16)) : nullptr;
+
+			if (!counter)
+			{
+				return 0;
+			}
+
+			value = reinterpret_cast<u64>(counter);
+		}
+		else
+		{
+			const auto found = get_link_table().find(name);
+
+			if (found == get_link_table().end())
+			{
+				// Not our symbol
+				return 0;
+			}
+
+			if (m_link_reset != m_spurt->get_reset_count())
+			{
+				// JIT memory has been reset
+				m_link_cells.clear();
+				m_link_reset = m_spurt->get_reset_count();
+			}
+
+			if (const u64 cell = m_link_cells[name])
+			{
+				return cell;
+			}
+
+			value = found->second;
+		}
+
+		// Allocate the cell near the code
+		const auto cell = jit_runtime::alloc(sizeof(u64), sizeof(u64), false);
+
+		if (!cell)
+		{
+			LOG_ERROR(SPU, "LLVM: Failed to allocate link cell for %s", name);
+			return 0;
+		}
+
+		std::memcpy(cell, &value, sizeof(u64));
+
+		if (get_link_table().count(name))
+		{
+			m_link_cells[name] = reinterpret_cast<u64>(cell);
+		}
+
+		return reinterpret_cast<u64>(cell);
 	}
 
 	// Add block with current block as a predecessor
@@ -2236,12 +2934,11 @@ class spu_llvm_recompiler : public spu_recompiler_base, public cpu_translator
 
 			// Generate a patchpoint for fixed location
 			const auto cblock = m_ir->GetInsertBlock();
-			const auto ppptr  = m_spurt->make_branch_patchpoint(target);
 			const auto result = llvm::BasicBlock::Create(m_context, "", m_function);
 			m_ir->SetInsertPoint(result);
 			m_ir->CreateStore(m_ir->getInt32(target), spu_ptr<u32>(&spu_thread::pc));
 			const auto type = llvm::FunctionType::get(get_type<void>(), {get_type<u8*>(), get_type<u8*>(), get_type<u32>()}, false)->getPointerTo();
-			tail(m_ir->CreateIntToPtr(m_ir->getInt64(reinterpret_cast<u64>(ppptr ? ppptr : &spu_recompiler_base::dispatch)), type));
+			tail(get_extern(fmt::format("spu-pp-0x%05x", target), type));
 			m_ir->SetInsertPoint(cblock);
 			return result;
 		}
@@ -2726,27 +3423,28 @@ class spu_llvm_recompiler : public spu_recompiler_base, public cpu_translator
 		m_ir->CreateCondBr(m_ir->CreateICmpEQ(m_ir->CreateLoad(pstate), m_ir->getInt32(0)), _body, check, m_md_likely);
 		m_ir->SetInsertPoint(check);
 		m_ir->CreateStore(m_ir->getInt32(addr), spu_ptr<u32>(&spu_thread::pc));
-		m_ir->CreateCondBr(call(&exec_check_state, m_thread), stop, _body, m_md_unlikely);
+		m_ir->CreateCondBr(call("spu_check_state", &exec_check_state, m_thread), stop, _body, m_md_unlikely);
 		m_ir->SetInsertPoint(stop);
 		m_ir->CreateRetVoid();
 		m_ir->SetInsertPoint(_body);
 	}
 
-	// Perform external call
+	// Perform external call (function must be registered in get_link_table())
 	template <typename RT, typename... FArgs, typename... Args>
-	llvm::CallInst* call(RT(*_func)(FArgs...), Args... args)
+	llvm::CallInst* call(const char* name, RT(*_func)(FArgs...), Args... args)
 	{
 		static_assert(sizeof...(FArgs) == sizeof...(Args), "spu_llvm_recompiler::call(): unexpected arg number");
-		const auto iptr = reinterpret_cast<std::uintptr_t>(_func);
+		const auto found = get_link_table().find(name);
+		verify("spu_llvm_recompiler::call()" HERE), found != get_link_table().end(), found->second == reinterpret_cast<u64>(_func);
 		const auto type = llvm::FunctionType::get(get_type<RT>(), {args->getType()...}, false)->getPointerTo();
-		return m_ir->CreateCall(m_ir->CreateIntToPtr(m_ir->getInt64(iptr), type), {args...});
+		return m_ir->CreateCall(get_extern(name, type), {args...});
 	}
 
 	// Perform external call and return
 	template <typename RT, typename... FArgs, typename... Args>
-	void tail(RT(*_func)(FArgs...), Args... args)
+	void tail(const char* name, RT(*_func)(FArgs...), Args... args)
 	{
-		const auto inst = call(_func, args...);
+		const auto inst = call(name, _func, args...);
 		inst->setTailCall();
 
 		if (inst->getType() == get_type<void>())
@@ -2780,7 +3478,59 @@ public:
 			m_cache = fxm::get<spu_cache>();
 			m_spurt = fxm::get_always<spu_runtime>();
 			m_context = m_jit.get_context();
+
+			if (g_cfg.core.spu_llvm_workers)
+			{
+				m_queue = fxm::get_always<spu_compile_queue>();
+			}
+
+			m_profile = fxm::get_always<spu_profile>();
 			m_use_ssse3 = m_jit.has_ssse3();
+			m_jit.set_resolver([this](const std::string& name) { return resolve(name); });
+
+			if (g_cfg.core.spu_cache && !g_cfg.core.spu_debug && !m_spurt->get_cache_path().empty())
+			{
+				// Settings which affect codegen
+				enum class spu_settings : u32
+				{
+					non_win32,
+					accurate_xfloat,
+					approx_xfloat,
+					loop_detection,
+					verification,
+					profiling,
+					async_mfc,
+
+					__bitset_enum_max
+				};
+
+				be_t<bs_t<spu_settings>> settings{};
+
+#ifndef _WIN32
+				settings += spu_settings::non_win32;
+#endif
+				if (g_cfg.core.spu_accurate_xfloat)
+					settings += spu_settings::accurate_xfloat;
+				if (g_cfg.core.spu_approx_xfloat)
+					settings += spu_settings::approx_xfloat;
+				if (g_cfg.core.spu_loop_detection)
+					settings += spu_settings::loop_detection;
+				if (g_cfg.core.spu_verification)
+					settings += spu_settings::verification;
+				if (g_cfg.core.spu_profiling)
+					settings += spu_settings::profiling;
+				if (g_cfg.core.spu_async_mfc)
+					settings += spu_settings::async_mfc;
+
+				// Object cache location (version, block size, settings, CPU)
+				m_obj_path = m_spurt->get_cache_path() + fmt::format("spu-llvm-v1-%s-%s-%s/", fmt::to_lower(g_cfg.core.spu_block_size.to_string()), fmt::base57(settings), jit_compiler::cpu(g_cfg.core.llvm_cpu));
+
+				if (!fs::create_path(m_obj_path))
+				{
+					LOG_ERROR(SPU, "LLVM: Failed to create object cache directory %s (%s)", m_obj_path, fs::g_tls_error);
+					m_obj_path.clear();
+				}
+			}
 
 			const auto md_name = llvm::MDString::get(m_context, "branch_weights");
 			const auto md_low = llvm::ValueAsMetadata::get(llvm::ConstantInt::get(GetType<u32>(), 1));
@@ -2818,6 +3568,65 @@ public:
 			fmt::append(hash, "spu-0x%05x-%s", func[0], fmt::base57(output));
 		}
 
+		// Block size differs from the one the object cache location is keyed on (promoted by the profile)
+		if (m_block_size != g_cfg.core.spu_block_size)
+		{
+			hash += '-';
+			hash += fmt::to_lower(fmt::format("%s", m_block_size));
+		}
+
+		// Hot functions from the profile are compiled differently
+		const bool is_hot = m_profile && m_profile->is_hot(func[0]);
+
+		if (is_hot)
+		{
+			hash += "-hot";
+		}
+
+		// Function content hash for the profile counter
+		const u64 prof_hash = spu_cache::hash(func);
+
+		if (m_profile && g_cfg.core.spu_profiling)
+		{
+			m_profile->add(prof_hash, func[0], ::size32(func) - 1);
+		}
+
+		if (!m_defined.count(hash) && !m_obj_path.empty() && m_jit.add(m_obj_path + hash + ".obj"))
+		{
+			// Link cached object (it may define the symbol even if the lookup fails)
+			m_defined.emplace(hash);
+			m_jit.fin();
+
+			if (const auto fn = reinterpret_cast<spu_function_t>(m_jit.get(hash)))
+			{
+				if (!m_spurt->add(last_reset_count, fn_location, fn))
+				{
+					return false;
+				}
+
+				if (m_cache && g_cfg.core.spu_cache)
+				{
+					m_cache->add(func, m_block_size);
+				}
+
+				LOG_NOTICE(SPU, "LLVM: Loaded %s", hash);
+				return true;
+			}
+
+			LOG_ERROR(SPU, "LLVM: Function not found in cached object: %s", hash);
+
+			// Rebuild on the next run
+			fs::remove_file(m_obj_path + hash + ".obj");
+		}
+
+		// Entry symbol name, the function is rebuilt under a new name if the engine already has one
+		std::string name = hash;
+
+		if (m_defined.count(hash))
+		{
+			fmt::append(name, "-r%u", ++m_rebuilds);
+		}
+
 		if (m_cache)
 		{
 			LOG_SUCCESS(SPU, "LLVM: Building %s (size %u)...", hash, func.size() - 1);
@@ -2830,14 +3639,14 @@ public:
 		SPUDisAsm dis_asm(CPUDisAsm_InterpreterMode);
 		dis_asm.offset = reinterpret_cast<const u8*>(func.data() + 1);
 
-		if (g_cfg.core.spu_block_size != spu_block_size_type::giga)
+		if (m_block_size != spu_block_size_type::giga)
 		{
 			dis_asm.offset -= func[0];
 		}
 
 		m_pos = func[0];
 		m_size = (func.size() - 1) * 4;
-		const u32 start = m_pos * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
+		const u32 start = m_pos * (m_block_size != spu_block_size_type::giga);
 		const u32 end = start + m_size;
 
 		if (g_cfg.core.spu_debug)
@@ -2874,7 +3683,7 @@ public:
 		using namespace llvm;
 
 		// Create LLVM module
-		std::unique_ptr<Module> module = std::make_unique<Module>(hash + ".obj", m_context);
+		std::unique_ptr<Module> module = std::make_unique<Module>(name + ".obj", m_context);
 		module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
 		m_module = module.get();
 
@@ -2883,7 +3692,7 @@ public:
 		m_ir = &irb;
 
 		// Add entry function (contains only state/code check)
-		const auto main_func = llvm::cast<llvm::Function>(m_module->getOrInsertFunction(hash, get_type<void>(), get_type<u8*>(), get_type<u8*>(), get_type<u8*>()));
+		const auto main_func = llvm::cast<llvm::Function>(m_module->getOrInsertFunction(name, get_type<void>(), get_type<u8*>(), get_type<u8*>(), get_type<u8*>()));
 		const auto main_arg2 = &*(main_func->arg_begin() + 2);
 		set_function(main_func);
 
@@ -2996,6 +3805,13 @@ public:
 		const auto pbcount = spu_ptr<u64>(&spu_thread::block_counter);
 		m_ir->CreateStore(m_ir->CreateAdd(m_ir->CreateLoad(pbcount), m_ir->getInt64(check_iterations)), pbcount);
 
+		if (m_profile && g_cfg.core.spu_profiling)
+		{
+			// Increase execution counter (not atomic, slight inaccuracy is acceptable)
+			const auto pcount = get_extern(fmt::format("spu-prof-%016x", prof_hash), get_type<u64*>());
+			m_ir->CreateStore(m_ir->CreateAdd(m_ir->CreateLoad(pcount), m_ir->getInt64(1)), pcount);
+		}
+
 		// Call the entry function chunk
 		const auto entry_chunk = add_function(m_pos);
 		m_ir->CreateCall(entry_chunk, {m_thread, m_lsptr, m_ir->getInt32(0)})->setTailCall();
@@ -3010,7 +3826,7 @@ public:
 		{
 			const auto pbfail = spu_ptr<u64>(&spu_thread::block_failure);
 			m_ir->CreateStore(m_ir->CreateAdd(m_ir->CreateLoad(pbfail), m_ir->getInt64(1)), pbfail);
-			tail(&spu_recompiler_base::dispatch, m_thread, m_ir->getInt32(0), main_arg2);
+			tail("spu_dispatch", &spu_recompiler_base::dispatch, m_thread, m_ir->getInt32(0), main_arg2);
 		}
 		else
 		{
@@ -3146,7 +3962,7 @@ public:
 				}
 
 				// State check at the beginning of the chunk
-				if (bi == 0 && g_cfg.core.spu_block_size != spu_block_size_type::safe)
+				if (bi == 0 && m_block_size != spu_block_size_type::safe)
 				{
 					check_state(baddr);
 				}
@@ -3267,6 +4083,19 @@ public:
 		pm.add(createDeadStoreEliminationPass());
 		pm.add(createLoopVersioningLICMPass());
 		pm.add(createAggressiveDCEPass());
+
+		if (is_hot)
+		{
+			// Additional optimizations for the hottest functions
+			pm.add(createInstructionCombiningPass());
+			pm.add(createReassociatePass());
+			pm.add(createSCCPPass());
+			pm.add(createLICMPass());
+			pm.add(createEarlyCSEPass());
+			pm.add(createCFGSimplificationPass());
+			pm.add(createAggressiveDCEPass());
+		}
+
 		//pm.add(createLintPass()); // Check
 
 		for (const auto& func : m_functions)
@@ -3311,11 +4140,17 @@ public:
 			// Testing only
 			m_jit.add(std::move(module), m_spurt->get_cache_path() + "llvm/");
 		}
+		else if (!m_obj_path.empty() && name == hash)
+		{
+			// Write object file to the cache
+			m_jit.add(std::move(module), m_obj_path);
+		}
 		else
 		{
 			m_jit.add(std::move(module));
 		}
 
+		m_defined.emplace(name);
 		m_jit.fin();
 
 		// Register function pointer
@@ -3334,7 +4169,7 @@ public:
 
 		if (m_cache && g_cfg.core.spu_cache)
 		{
-			m_cache->add(func);
+			m_cache->add(func, m_block_size);
 		}
 
 		return true;
@@ -3345,22 +4180,6 @@ public:
 		return _spu->check_state();
 	}
 
-	template <spu_inter_func_t F>
-	static void exec_fall(spu_thread* _spu, spu_opcode_t op)
-	{
-		if (F(*_spu, op))
-		{
-			_spu->pc += 4;
-		}
-	}
-
-	template <spu_inter_func_t F>
-	void fall(spu_opcode_t op)
-	{
-		update_pc();
-		call(&exec_fall<F>, m_thread, m_ir->getInt32(op.opcode));
-	}
-
 	static void exec_unk(spu_thread* _spu, u32 op)
 	{
 		fmt::throw_exception("Unknown/Illegal instruction (0x%08x)" HERE, op);
@@ -3370,7 +4189,7 @@ public:
 	{
 		m_block->block_end = m_ir->GetInsertBlock();
 		update_pc();
-		tail(&exec_unk, m_thread, m_ir->getInt32(op_unk.opcode));
+		tail("spu_unk", &exec_unk, m_thread, m_ir->getInt32(op_unk.opcode));
 	}
 
 	static bool exec_stop(spu_thread* _spu, u32 code)
@@ -3381,7 +4200,7 @@ public:
 	void STOP(spu_opcode_t op) //
 	{
 		update_pc();
-		const auto succ = call(&exec_stop, m_thread, m_ir->getInt32(op.opcode & 0x3fff));
+		const auto succ = call("spu_stop", &exec_stop, m_thread, m_ir->getInt32(op.opcode & 0x3fff));
 		const auto next = llvm::BasicBlock::Create(m_context, "", m_function);
 		const auto stop = llvm::BasicBlock::Create(m_context, "", m_function);
 		m_ir->CreateCondBr(succ, next, stop);
@@ -3389,7 +4208,7 @@ public:
 		m_ir->CreateRetVoid();
 		m_ir->SetInsertPoint(next);
 
-		if (g_cfg.core.spu_block_size == spu_block_size_type::safe)
+		if (m_block_size == spu_block_size_type::safe)
 		{
 			m_block->block_end = m_ir->GetInsertBlock();
 			m_ir->CreateStore(m_ir->getInt32(m_pos + 4), spu_ptr<u32>(&spu_thread::pc));
@@ -3463,7 +4282,7 @@ public:
 		const auto stop = llvm::BasicBlock::Create(m_context, "", m_function);
 		m_ir->CreateCondBr(m_ir->CreateICmpSLT(val0, m_ir->getInt64(0)), done, wait);
 		m_ir->SetInsertPoint(wait);
-		const auto val1 = call(&exec_rdch, m_thread, m_ir->getInt32(op.ra));
+		const auto val1 = call("spu_rdch", &exec_rdch, m_thread, m_ir->getInt32(op.ra));
 		m_ir->CreateCondBr(m_ir->CreateICmpSLT(val1, m_ir->getInt64(0)), stop, done);
 		m_ir->SetInsertPoint(stop);
 		m_ir->CreateRetVoid();
@@ -3488,7 +4307,7 @@ public:
 		case SPU_RdInMbox:
 		{
 			update_pc();
-			res.value = call(&exec_read_in_mbox, m_thread);
+			res.value = call("spu_read_in_mbox", &exec_read_in_mbox, m_thread);
 			const auto next = llvm::BasicBlock::Create(m_context, "", m_function);
 			const auto stop = llvm::BasicBlock::Create(m_context, "", m_function);
 			m_ir->CreateCondBr(m_ir->CreateICmpSLT(res.value, m_ir->getInt64(0)), stop, next);
@@ -3530,7 +4349,7 @@ public:
 		}
 		case SPU_RdDec:
 		{
-			res.value = call(&exec_read_dec, m_thread);
+			res.value = call("spu_read_dec", &exec_read_dec, m_thread);
 			break;
 		}
 		case SPU_RdEventMask:
@@ -3541,7 +4360,7 @@ public:
 		case SPU_RdEventStat:
 		{
 			update_pc();
-			res.value = call(&exec_read_events, m_thread);
+			res.value = call("spu_read_events", &exec_read_events, m_thread);
 			const auto next = llvm::BasicBlock::Create(m_context, "", m_function);
 			const auto stop = llvm::BasicBlock::Create(m_context, "", m_function);
 			m_ir->CreateCondBr(m_ir->CreateICmpSLT(res.value, m_ir->getInt64(0)), stop, next);
@@ -3560,7 +4379,7 @@ public:
 		default:
 		{
 			update_pc();
-			res.value = call(&exec_rdch, m_thread, m_ir->getInt32(op.ra));
+			res.value = call("spu_rdch", &exec_rdch, m_thread, m_ir->getInt32(op.ra));
 			const auto next = llvm::BasicBlock::Create(m_context, "", m_function);
 			const auto stop = llvm::BasicBlock::Create(m_context, "", m_function);
 			m_ir->CreateCondBr(m_ir->CreateICmpSLT(res.value, m_ir->getInt64(0)), stop, next);
@@ -3610,6 +4429,13 @@ public:
 		}
 		case MFC_RdTagStat:
 		{
+			if (g_cfg.core.spu_async_mfc)
+			{
+				// Tag status may depend on the DMA worker
+				res.value = call("spu_rchcnt", &exec_rchcnt, m_thread, m_ir->getInt32(op.ra));
+				break;
+			}
+
 			res.value = get_rchcnt(::offset32(&spu_thread::ch_tag_stat));
 			break;
 		}
@@ -3655,7 +4481,7 @@ public:
 		}
 		case SPU_RdEventStat:
 		{
-			res.value = call(&exec_get_events, m_thread);
+			res.value = call("spu_get_events", &exec_get_events, m_thread);
 			res.value = m_ir->CreateICmpNE(res.value, m_ir->getInt32(0));
 			res.value = m_ir->CreateZExt(res.value, get_type<u32>());
 			break;
@@ -3663,7 +4489,7 @@ public:
 
 		default:
 		{
-			res.value = call(&exec_rchcnt, m_thread, m_ir->getInt32(op.ra));
+			res.value = call("spu_rchcnt", &exec_rchcnt, m_thread, m_ir->getInt32(op.ra));
 			break;
 		}
 		}
@@ -3728,6 +4554,12 @@ public:
 		}
 		case MFC_WrTagUpdate:
 		{
+			if (g_cfg.core.spu_async_mfc)
+			{
+				// Tag status may depend on the DMA worker
+				break;
+			}
+
 			if (auto ci = llvm::dyn_cast<llvm::ConstantInt>(val.value))
 			{
 				const u64 upd = ci->getZExtValue();
@@ -3812,6 +4644,12 @@ public:
 				break;
 			}
 
+			if (g_cfg.core.spu_async_mfc)
+			{
+				// Transfers may be handed to the DMA worker
+				break;
+			}
+
 			if (auto ci = llvm::dyn_cast<llvm::ConstantInt>(trunc<u8>(val).value))
 			{
 				const auto eal = get_vr<u32>(s_reg_mfc_eal);
@@ -3851,7 +4689,7 @@ public:
 					m_ir->CreateUnreachable();
 					m_ir->SetInsertPoint(next);
 					m_ir->CreateStore(ci, spu_ptr<u8>(&spu_thread::ch_mfc_cmd, &spu_mfc_cmd::cmd));
-					call(&exec_mfc_cmd, m_thread);
+					call("spu_mfc_cmd", &exec_mfc_cmd, m_thread);
 					return;
 				}
 				case MFC_SNDSIG_CMD:
@@ -3904,7 +4742,7 @@ public:
 					m_ir->CreateCondBr(m_ir->CreateICmpUGE(eal.value, m_ir->getInt32(0xe0000000)), mmio, copy, m_md_unlikely);
 					m_ir->SetInsertPoint(mmio);
 					m_ir->CreateStore(ci, spu_ptr<u8>(&spu_thread::ch_mfc_cmd, &spu_mfc_cmd::cmd));
-					call(&exec_mfc_cmd, m_thread);
+					call("spu_mfc_cmd", &exec_mfc_cmd, m_thread);
 					m_ir->CreateBr(next);
 					m_ir->SetInsertPoint(copy);
 
@@ -4081,14 +4919,14 @@ public:
 			const auto _mfc = llvm::BasicBlock::Create(m_context, "", m_function);
 			m_ir->CreateCondBr(m_ir->CreateICmpNE(_old, _new), _mfc, next);
 			m_ir->SetInsertPoint(_mfc);
-			call(&exec_list_unstall, m_thread, eval(val & 0x1f).value);
+			call("spu_list_unstall", &exec_list_unstall, m_thread, eval(val & 0x1f).value);
 			m_ir->CreateBr(next);
 			m_ir->SetInsertPoint(next);
 			return;
 		}
 		case SPU_WrDec:
 		{
-			m_ir->CreateStore(call(&get_timebased_time), spu_ptr<u64>(&spu_thread::ch_dec_start_timestamp));
+			m_ir->CreateStore(call("get_timebased_time", &get_timebased_time), spu_ptr<u64>(&spu_thread::ch_dec_start_timestamp));
 			m_ir->CreateStore(val.value, spu_ptr<u32>(&spu_thread::ch_dec_value));
 			return;
 		}
@@ -4109,7 +4947,7 @@ public:
 		}
 
 		update_pc();
-		const auto succ = call(&exec_wrch, m_thread, m_ir->getInt32(op.ra), val.value);
+		const auto succ = call("spu_wrch", &exec_wrch, m_thread, m_ir->getInt32(op.ra), val.value);
 		const auto next = llvm::BasicBlock::Create(m_context, "", m_function);
 		const auto stop = llvm::BasicBlock::Create(m_context, "", m_function);
 		m_ir->CreateCondBr(succ, next, stop);
@@ -4131,7 +4969,7 @@ public:
 		// This instruction must be used following a store instruction that modifies the instruction stream.
 		m_ir->CreateFence(llvm::AtomicOrdering::SequentiallyConsistent);
 
-		if (g_cfg.core.spu_block_size == spu_block_size_type::safe)
+		if (m_block_size == spu_block_size_type::safe)
 		{
 			m_block->block_end = m_ir->GetInsertBlock();
 			m_ir->CreateStore(m_ir->getInt32(m_pos + 4), spu_ptr<u32>(&spu_thread::pc));
@@ -5889,7 +6727,7 @@ public:
 		// Load stack addr if necessary
 		value_t<u32> sp;
 
-		if (ret && g_cfg.core.spu_block_size != spu_block_size_type::safe)
+		if (ret && m_block_size != spu_block_size_type::safe)
 		{
 			sp = eval(extract(get_vr(1), 3) & 0x3fff0);
 		}
@@ -5900,7 +6738,7 @@ public:
 
 		if (op.e)
 		{
-			addr.value = call(&exec_check_interrupts, m_thread, addr.value);
+			addr.value = call("spu_check_interrupts", &exec_check_interrupts, m_thread, addr.value);
 		}
 
 		if (op.d)
@@ -5910,10 +6748,10 @@ public:
 
 		m_ir->CreateStore(addr.value, spu_ptr<u32>(&spu_thread::pc));
 		const auto type = llvm::FunctionType::get(get_type<void>(), {get_type<u8*>(), get_type<u8*>(), get_type<u32>()}, false)->getPointerTo()->getPointerTo();
-		const auto disp = m_ir->CreateIntToPtr(m_ir->getInt64((u64)spu_runtime::g_dispatcher), type);
+		const auto disp = get_extern("spu_dispatcher", type);
 		const auto ad64 = m_ir->CreateZExt(addr.value, get_type<u64>());
 
-		if (ret && g_cfg.core.spu_block_size != spu_block_size_type::safe)
+		if (ret && m_block_size != spu_block_size_type::safe)
 		{
 			// Compare address stored in stack mirror with addr
 			const auto stack0 = eval(zext<u64>(sp) + ::offset32(&spu_thread::stack_mirror));
@@ -5933,7 +6771,7 @@ public:
 
 		llvm::Value* ptr = m_ir->CreateGEP(disp, m_ir->CreateLShr(ad64, 2, "", true));
 
-		if (g_cfg.core.spu_block_size == spu_block_size_type::giga)
+		if (m_block_size == spu_block_size_type::giga)
 		{
 			// Try to load chunk address from the function table
 			const auto use_ftable = m_ir->CreateICmpULT(ad64, m_ir->getInt64(m_size));
@@ -6153,7 +6991,7 @@ public:
 	{
 		set_vr(op.rt, build<u32[4]>(0, 0, 0, spu_branch_target(m_pos + 4)));
 
-		if (g_cfg.core.spu_block_size != spu_block_size_type::safe && m_block_info[m_pos / 4 + 1] && m_entry_info[m_pos / 4 + 1])
+		if (m_block_size != spu_block_size_type::safe && m_block_info[m_pos / 4 + 1] && m_entry_info[m_pos / 4 + 1])
 		{
 			// Store the return function chunk address at the stack mirror
 			const auto func = add_function(m_pos + 4);
@@ -10,13 +10,69 @@
 #include <memory>
 #include <string>
 #include <deque>
+#include <unordered_set>
+
+enum class spu_block_size_type;
 
 // Helper class
 class spu_cache
 {
 	fs::file m_file;
 
+	// Memory-mapped file contents (entries existing at load time)
+	fs::file_view m_view;
+
+	// Content hash index (hash -> entry offsets in the file, contents are compared on collision)
+	std::unordered_multimap<u64, u64, value_hash<u64>> m_index;
+
+	// Protects m_file and m_index in add()
+	shared_mutex m_mutex;
+
+	// Path to the cache file
+	std::string m_path;
+
+	// Number of duplicate entries found by get()
+	u64 m_dups = 0;
+
+	// Check whether the entry at the offset contains the function (m_mutex must be locked)
+	bool stored_at(u64 pos, const std::vector<u32>& func) const;
+
 public:
+	// Entry header (big-endian, followed by the function data)
+	struct entry_header
+	{
+		be_t<u32> size; // Number of instruction words
+		be_t<u32> addr; // Entry point
+		be_t<u64> hash; // Content hash, see spu_cache::hash()
+		be_t<u32> block_size; // spu_block_size_type the function was analysed with
+		be_t<u32> reserved;
+	};
+
+	// File header
+	struct file_header
+	{
+		be_t<u64> magic;
+		be_t<u32> version;
+		be_t<u32> reserved;
+	};
+
+	// Function entry (data points into the mapped file)
+	struct entry
+	{
+		u32 addr;
+		u32 size;
+		const u32* data;
+		spu_block_size_type block_size;
+
+		// Get function in the format used by the recompiler (addr + raw instruction data)
+		void get(std::vector<u32>& func) const
+		{
+			func.resize(size + 1);
+			func[0] = addr;
+			std::memcpy(func.data() + 1, data, size * 4);
+		}
+	};
+
 	spu_cache(const std::string& loc);
 
 	~spu_cache();
@@ -26,13 +82,85 @@ public:
 		return m_file.operator bool();
 	}
 
-	std::deque<std::vector<u32>> get();
+	// Map the file and build the index, returns entries in the most-recent-first order
+	std::vector<entry> get();
+
+	// Append function if it's not present yet
+	void add(const std::vector<u32>& func, spu_block_size_type block_size);
 
-	void add(const std::vector<u32>& func);
+	// Rewrite the file leaving only unique valid entries (invalidates entries returned by get())
+	bool compact();
+
+	// Check whether the file contains duplicate entries
+	bool needs_compaction() const
+	{
+		return m_dups != 0;
+	}
+
+	// Compute content hash of the function (including entry point)
+	static u64 hash(const std::vector<u32>& func);
 
 	static void initialize();
 };
 
+// SPU function execution profile (counters are emitted by the LLVM backend, saved alongside the SPU cache)
+class spu_profile
+{
+	struct counter
+	{
+		u32 addr;
+		u32 size;
+		atomic_t<u64> count{0};
+	};
+
+	// Counters by content hash (see spu_cache::hash)
+	std::unordered_map<u64, counter, value_hash<u64>> m_counters;
+
+	// Protects m_counters
+	shared_mutex m_mutex;
+
+	// Entry points of the hottest functions in the loaded profile
+	std::bitset<0x10000> m_hot;
+
+	// Path to the profile file
+	std::string m_path;
+
+public:
+	// Entry (big-endian)
+	struct entry
+	{
+		be_t<u64> hash;
+		be_t<u32> addr;
+		be_t<u32> size;
+		be_t<u64> count;
+	};
+
+	// File header
+	struct file_header
+	{
+		be_t<u64> magic;
+		be_t<u32> version;
+		be_t<u32> count;
+	};
+
+	spu_profile();
+
+	// Save the profile (if enabled)
+	~spu_profile();
+
+	// Register function counter
+	void add(u64 hash, u32 addr, u32 size);
+
+	// Get counter address (null if not registered)
+	atomic_t<u64>* find(u64 hash);
+
+	// Check whether the function at the entry point was hot in the loaded profile
+	bool is_hot(u32 addr) const
+	{
+		return m_hot[addr / 4];
+	}
+};
+
 // Helper class
 class spu_runtime
 {
@@ -44,50 +172,54 @@ class spu_runtime
 
 	atomic_t<u64> m_reset_count{0};
 
-	// All functions
-	std::map<std::vector<u32>, spu_function_t> m_map;
+	// Function entry (immutable after publication, except for the compiled pointer)
+	struct func_entry
+	{
+		// Function data (addr + raw instruction data)
+		std::vector<u32> data;
 
-	// Debug module output location
-	std::string m_cache_path;
+		// Content hash (see spu_cache::hash)
+		u64 hash;
 
-	// Trampoline generation workload helper
-	struct work
-	{
-		u32 size;
-		u16 from;
-		u16 level;
-		u8* rel32;
-		std::map<std::vector<u32>, spu_function_t>::iterator beg;
-		std::map<std::vector<u32>, spu_function_t>::iterator end;
-	};
+		// Compiled function (null while compilation is in progress)
+		atomic_t<spu_function_t> compiled{};
 
-	// Scratch vector
-	static thread_local std::vector<work> workload;
+		// Set when the function is reachable from the dispatcher (protected by m_mutex)
+		bool linked = false;
 
-	// Scratch vector
-	static thread_local std::vector<u32> addrv;
+		// Next entry at the same LS address
+		func_entry* next = nullptr;
+	};
 
-	// Trampoline to spu_recompiler_base::dispatch
-	static const spu_function_t tr_dispatch;
+	// All functions: lock-free list heads for each LS address (entries are only freed in reset())
+	std::unique_ptr<atomic_t<func_entry*>[]> m_index;
+
+	// Debug module output location
+	std::string m_cache_path;
 
 	// Trampoline to spu_recompiler_base::branch
 	static const spu_function_t tr_branch;
 
+	// Free all function entries
+	void clear_index();
+
 public:
 	spu_runtime();
 
+	~spu_runtime();
+
 	const std::string& get_cache_path() const
 	{
 		return m_cache_path;
 	}
 
-	// Add compiled function and generate trampoline if necessary
+	// Add compiled function and link it to the dispatcher (generates a small trampoline if necessary)
 	bool add(u64 last_reset_count, void* where, spu_function_t compiled);
 
-	// Return opaque pointer for add()
+	// Return opaque pointer for add() (lock-free unless the function is being compiled by another thread)
 	void* find(u64 last_reset_count, const std::vector<u32>&);
 
-	// Find existing function
+	// Find existing function (lock-free)
 	spu_function_t find(const se_t<u32, false>* ls, u32 addr) const;
 
 	// Generate a patchable trampoline to spu_recompiler_base::branch
@@ -154,31 +286,57 @@ public:
 			}
 		}
 	};
+};
 
-	struct reader_lock
+// Background compilation queue (tiered mode: new code is interpreted until compiled by LLVM workers)
+class spu_compile_queue
+{
+	struct job
 	{
-		const spu_runtime& _this;
+		// Key from make_key()
+		u64 key;
 
-		reader_lock(const reader_lock&) = delete;
+		// Function data (addr + raw instruction data)
+		std::vector<u32> func;
+	};
 
-		reader_lock(const spu_runtime& _this)
-			: _this(_this)
-		{
-			_this.m_passive_locks--;
-			_this.m_mutex.lock_shared();
-		}
+	shared_mutex m_mutex;
 
-		~reader_lock()
-		{
-			_this.m_passive_locks++;
-			_this.m_mutex.unlock_shared();
-		}
-	};
+	cond_variable m_cond;
+
+	// Functions waiting for compilation
+	std::deque<job> m_jobs;
+
+	// Keys of all queued functions and functions being compiled
+	std::unordered_set<u64, value_hash<u64>> m_pending;
+
+	bool m_stop = false;
+
+	// Worker threads (each one owns an LLVM recompiler instance)
+	std::deque<named_thread<std::function<void()>>> m_workers;
+
+	void work();
+
+public:
+	spu_compile_queue();
+
+	~spu_compile_queue();
+
+	// Check whether the function at the location is queued or being compiled
+	bool is_pending(u64 key);
+
+	// Queue function for compilation (returns false if already pending)
+	bool push(u64 key, const std::vector<u32>& func);
+
+	// Get cheap identification key for the code at specified LS address
+	static u64 make_key(const be_t<u32>* ls, u32 addr);
 };
 
 // SPU Recompiler instance base class
 class spu_recompiler_base
 {
+	friend class spu_compile_queue;
+
 protected:
 	std::shared_ptr<spu_runtime> m_spurt;
 
@@ -205,6 +363,15 @@ protected:
 
 	std::shared_ptr<spu_cache> m_cache;
 
+	// Background compilation queue (only set in tiered mode)
+	std::shared_ptr<spu_compile_queue> m_queue;
+
+	// Execution profile (LLVM only)
+	std::shared_ptr<spu_profile> m_profile;
+
+	// Block size used by the last analyse() call (may differ from the setting for hot functions)
+	spu_block_size_type m_block_size;
+
 private:
 	// For private use
 	std::bitset<0x10000> m_bits;
@@ -232,9 +399,18 @@ public:
 	// Target for the unresolved patch point (second arg is unused)
 	static void branch(spu_thread&, void*, u8* rip);
 
-	// Get the function data at specified address
+	// Execute instructions with the interpreter until the next branch or compiled function entry
+	static void interpret(spu_thread&);
+
+	// Get the function data at specified address (block size is selected by get_block_size())
 	const std::vector<u32>& analyse(const be_t<u32>* ls, u32 lsa);
 
+	// Get the function data at specified address, analysed with the specified block size
+	const std::vector<u32>& analyse(const be_t<u32>* ls, u32 lsa, spu_block_size_type block_size);
+
+	// Get block size for the function (hot functions may be promoted from Safe to Mega)
+	spu_block_size_type get_block_size(u32 entry_point) const;
+
 	// Print analyser internal state
 	void dump(std::string& out);
 
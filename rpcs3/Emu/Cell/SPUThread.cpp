@@ -186,6 +186,89 @@ namespace spu
 	}
 }
 
+// Bulk DMA copy (size must be a multiple of 16)
+const auto spu_dma_copy = build_function_asm<void(*)(void* dst, const void* src, u32 size)>([](asmjit::X86Assembler& c, auto& args)
+{
+	using namespace asmjit;
+
+	Label loop = c.newLabel();
+	Label tail = c.newLabel();
+	Label end = c.newLabel();
+
+	const bool avx = utils::has_avx();
+
+	c.mov(x86::eax, args[2].r32());
+	c.cmp(x86::eax, 128);
+	c.jb(tail);
+
+	// Copy 128 bytes per iteration (Windows has only 6 volatile vector registers)
+	c.bind(loop);
+
+	if (avx)
+	{
+		c.vmovups(x86::ymm0, x86::yword_ptr(args[1], 0));
+		c.vmovups(x86::ymm1, x86::yword_ptr(args[1], 32));
+		c.vmovups(x86::ymm2, x86::yword_ptr(args[1], 64));
+		c.vmovups(x86::ymm3, x86::yword_ptr(args[1], 96));
+		c.vmovups(x86::yword_ptr(args[0], 0), x86::ymm0);
+		c.vmovups(x86::yword_ptr(args[0], 32), x86::ymm1);
+		c.vmovups(x86::yword_ptr(args[0], 64), x86::ymm2);
+		c.vmovups(x86::yword_ptr(args[0], 96), x86::ymm3);
+	}
+	else
+	{
+		for (u32 i = 0; i < 128; i += 64)
+		{
+			c.movups(x86::xmm0, x86::oword_ptr(args[1], i + 0));
+			c.movups(x86::xmm1, x86::oword_ptr(args[1], i + 16));
+			c.movups(x86::xmm2, x86::oword_ptr(args[1], i + 32));
+			c.movups(x86::xmm3, x86::oword_ptr(args[1], i + 48));
+			c.movups(x86::oword_ptr(args[0], i + 0), x86::xmm0);
+			c.movups(x86::oword_ptr(args[0], i + 16), x86::xmm1);
+			c.movups(x86::oword_ptr(args[0], i + 32), x86::xmm2);
+			c.movups(x86::oword_ptr(args[0], i + 48), x86::xmm3);
+		}
+	}
+
+	c.add(args[0], 128);
+	c.add(args[1], 128);
+	c.sub(x86::eax, 128);
+	c.cmp(x86::eax, 128);
+	c.jae(loop);
+
+	// Copy remaining 16-byte blocks
+	c.bind(tail);
+	c.test(x86::eax, x86::eax);
+	c.jz(end);
+	Label loop16 = c.newLabel();
+	c.bind(loop16);
+
+	if (avx)
+	{
+		c.vmovups(x86::xmm0, x86::oword_ptr(args[1]));
+		c.vmovups(x86::oword_ptr(args[0]), x86::xmm0);
+	}
+	else
+	{
+		c.movups(x86::xmm0, x86::oword_ptr(args[1]));
+		c.movups(x86::oword_ptr(args[0]), x86::xmm0);
+	}
+
+	c.add(args[0], 16);
+	c.add(args[1], 16);
+	c.sub(x86::eax, 16);
+	c.jnz(loop16);
+
+	c.bind(end);
+
+	if (avx)
+	{
+		c.vzeroupper();
+	}
+
+	c.ret();
+});
+
 const auto spu_putllc_tx = build_function_asm<u32(*)(u32 raddr, u64 rtime, const void* _old, const void* _new)>([](asmjit::X86Assembler& c, auto& args)
 {
 	using namespace asmjit;
@@ -471,6 +554,8 @@ void spu_thread::cpu_init()
 	ch_tag_upd = 0;
 	ch_tag_mask = 0;
 	mfc_prxy_mask = 0;
+	mfc_async_seq = {};
+	mfc_async_last = mfc_async_done.load();
 	ch_tag_stat.data.release({});
 	ch_stall_mask = 0;
 	ch_stall_stat.data.release({});
@@ -507,6 +592,9 @@ void spu_thread::cpu_init()
 
 void spu_thread::cpu_stop()
 {
+	// Complete asynchronous transfers before the thread state becomes observable
+	do_mfc_async_wait(mfc_async_last);
+
 	if (!group && offset >= RAW_SPU_BASE_ADDR)
 	{
 		// Save next PC and current SPU Interrupt Status
@@ -875,23 +963,7 @@ void spu_thread::do_dma_transfer(const spu_mfc_cmd& args)
 
 			auto lock = vm::passive_lock(eal & -128u, ::align(eal + size, 128));
 
-			while (size >= 128)
-			{
-				mov_rdata(reinterpret_cast<u128*>(dst), reinterpret_cast<const u128*>(src));
-
-				dst += 128;
-				src += 128;
-				size -= 128;
-			}
-
-			while (size)
-			{
-				*reinterpret_cast<u128*>(dst) = *reinterpret_cast<const u128*>(src);
-
-				dst += 16;
-				src += 16;
-				size -= 16;
-			}
+			spu_dma_copy(dst, src, size);
 
 			lock->release(0);
 			break;
@@ -930,24 +1002,7 @@ void spu_thread::do_dma_transfer(const spu_mfc_cmd& args)
 	}
 	default:
 	{
-		while (size >= 128)
-		{
-			mov_rdata(reinterpret_cast<u128*>(dst), reinterpret_cast<const u128*>(src));
-
-			dst += 128;
-			src += 128;
-			size -= 128;
-		}
-
-		while (size)
-		{
-			*reinterpret_cast<u128*>(dst) = *reinterpret_cast<const u128*>(src);
-
-			dst += 16;
-			src += 16;
-			size -= 16;
-		}
-
+		spu_dma_copy(dst, src, size);
 		break;
 	}
 	}
@@ -957,6 +1012,12 @@ bool spu_thread::do_dma_check(const spu_mfc_cmd& args)
 {
 	const u32 mask = utils::rol32(1, args.tag);
 
+	if (UNLIKELY(args.cmd & (MFC_BARRIER_MASK | MFC_FENCE_MASK) && mfc_async_seq[args.tag & 0x1f] > mfc_async_done.load()))
+	{
+		// Complete asynchronous transfers of the same tag first
+		do_mfc_async_wait(mfc_async_seq[args.tag & 0x1f]);
+	}
+
 	if (UNLIKELY(mfc_barrier & mask || (args.cmd & (MFC_BARRIER_MASK | MFC_FENCE_MASK) && mfc_fence & mask)))
 	{
 		// Check for special value combination (normally impossible)
@@ -1032,13 +1093,38 @@ bool spu_thread::do_list_transfer(spu_mfc_cmd& args)
 		args.lsa &= 0x3fff0;
 		item = _ref<list_element>(args.eal & 0x3fff8);
 
-		const u32 size = item.ts & 0x7fff;
+		u32 size = item.ts & 0x7fff;
 		const u32 addr = item.ea;
 
 		LOG_TRACE(SPU, "LIST: addr=0x%x, size=0x%x, lsa=0x%05x, sb=0x%x", addr, size, args.lsa | (addr & 0xf), item.sb);
 
+		// Coalesce following elements which continue the transfer in both memory and LS (aligned, no stall)
+		// Merged transfers don't exceed the largest single MFC transfer (0x4000)
+		bool merged = false;
+
+		while (size && size % 16 == 0 && addr % 16 == 0 && !(item.sb & 0x8000) && args.size > 8)
+		{
+			const list_element next = _ref<list_element>((args.eal + 8) & 0x3fff8);
+			const u32 next_size = next.ts & 0x7fff;
+
+			if (!next_size || next_size % 16 || size + next_size > 0x4000 || next.ea != u64{addr} + size || u64{next.ea} + next_size > RAW_SPU_BASE_ADDR || args.lsa + size + next_size > 0x40000)
+			{
+				break;
+			}
+
+			LOG_TRACE(SPU, "LIST: addr=0x%x, size=0x%x, lsa=0x%05x, sb=0x%x (merged)", next.ea, next_size, args.lsa + size, next.sb);
+
+			item = next;
+			size += next_size;
+			merged = true;
+			args.eal += 8;
+			args.size -= 8;
+		}
+
 		if (size)
 		{
+			verify("MFC list merge" HERE), !merged || size <= 0x4000;
+
 			spu_mfc_cmd transfer;
 			transfer.eal  = addr;
 			transfer.eah  = 0;
@@ -1221,7 +1307,164 @@ void spu_thread::do_mfc(bool wait)
 
 u32 spu_thread::get_mfc_completed()
 {
-	return ch_tag_mask & ~mfc_fence;
+	return ch_tag_mask & ~mfc_fence & ~get_mfc_async_pending();
+}
+
+spu_dma_worker::spu_dma_worker(const std::string& name)
+	: m_thread("SPU DMA " + name, [this]{ work(); })
+{
+}
+
+spu_dma_worker::~spu_dma_worker()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_cond.notify_all();
+}
+
+void spu_dma_worker::work()
+{
+	while (true)
+	{
+		job next;
+
+		{
+			std::lock_guard lock(m_mutex);
+
+			while (m_jobs.empty() && !m_stop && !Emu.IsStopped())
+			{
+				m_cond.wait(m_mutex, 10000);
+			}
+
+			if (m_stop || Emu.IsStopped())
+			{
+				break;
+			}
+
+			next = m_jobs.front();
+			m_jobs.pop_front();
+		}
+
+		next.spu->do_dma_transfer(next.cmd);
+		next.spu->mfc_async_done.release(next.seq);
+		next.spu->notify();
+	}
+}
+
+void spu_dma_worker::push(spu_thread& spu, const spu_mfc_cmd& cmd, u64 seq)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_jobs.push_back({&spu, cmd, seq});
+	}
+
+	m_cond.notify_one();
+}
+
+bool spu_thread::do_mfc_async(const spu_mfc_cmd& args)
+{
+	if (!group || !group->dma)
+	{
+		return false;
+	}
+
+	// Only plain GET/PUT to main memory, small transfers are cheaper to perform immediately
+	if ((args.cmd != MFC_GET_CMD && args.cmd != MFC_PUT_CMD && args.cmd != MFC_PUTR_CMD) || args.size < 256 || u64{args.eal} + args.size > RAW_SPU_BASE_ADDR)
+	{
+		return false;
+	}
+
+	const u64 seq = ++mfc_async_last;
+	mfc_async_seq[args.tag & 0x1f] = seq;
+	group->dma->push(*this, args, seq);
+	return true;
+}
+
+void spu_thread::do_mfc_async_wait(u64 seq)
+{
+	for (u32 i = 0; mfc_async_done.load() < seq; i++)
+	{
+		// Only abandon transfers if the emulation is stopped (they may access LS)
+		if (Emu.IsStopped())
+		{
+			break;
+		}
+
+		if (i < 10)
+		{
+			busy_wait();
+		}
+		else
+		{
+			thread_ctrl::wait_for(100);
+		}
+	}
+}
+
+void spu_thread::do_mfc_async_update(bool wait)
+{
+	if (!ch_tag_upd)
+	{
+		return;
+	}
+
+	if (wait)
+	{
+		// Wait for the first (ANY) or the last (ALL) pending transfer of the selected tags
+		const u64 done = mfc_async_done.load();
+		u64 seq = ch_tag_upd == 1 ? UINT64_MAX : 0;
+
+		for (u32 i = 0; i < 32; i++)
+		{
+			if (ch_tag_mask & (1u << i) && mfc_async_seq[i] > done)
+			{
+				seq = ch_tag_upd == 1 ? std::min(seq, mfc_async_seq[i]) : std::max(seq, mfc_async_seq[i]);
+			}
+		}
+
+		if (seq != UINT64_MAX)
+		{
+			do_mfc_async_wait(seq);
+		}
+	}
+
+	const u32 completed = get_mfc_completed();
+
+	if (completed && ch_tag_upd == 1)
+	{
+		ch_tag_stat.set_value(completed);
+		ch_tag_upd = 0;
+	}
+	else if (completed == ch_tag_mask && ch_tag_upd == 2)
+	{
+		ch_tag_stat.set_value(completed);
+		ch_tag_upd = 0;
+	}
+}
+
+u32 spu_thread::get_mfc_async_pending()
+{
+	const u64 done = mfc_async_done.load();
+
+	if (LIKELY(mfc_async_last <= done))
+	{
+		return 0;
+	}
+
+	u32 result = 0;
+
+	for (u32 i = 0; i < 32; i++)
+	{
+		if (mfc_async_seq[i] > done)
+		{
+			result |= 1u << i;
+		}
+	}
+
+	return result;
 }
 
 bool spu_thread::process_mfc_cmd()
@@ -1472,7 +1715,7 @@ bool spu_thread::process_mfc_cmd()
 		{
 			if (LIKELY(do_dma_check(ch_mfc_cmd)))
 			{
-				if (ch_mfc_cmd.size)
+				if (ch_mfc_cmd.size && !do_mfc_async(ch_mfc_cmd))
 				{
 					do_dma_transfer(ch_mfc_cmd);
 				}
@@ -1533,6 +1776,9 @@ bool spu_thread::process_mfc_cmd()
 	case MFC_EIEIO_CMD:
 	case MFC_SYNC_CMD:
 	{
+		// Complete all asynchronous transfers
+		do_mfc_async_wait(mfc_async_last);
+
 		if (mfc_size == 0)
 		{
 			_mm_mfence();
@@ -1638,7 +1884,6 @@ u32 spu_thread::get_ch_count(u32 ch)
 	case SPU_WrOutMbox:       return ch_out_mbox.get_count() ^ 1;
 	case SPU_WrOutIntrMbox:   return ch_out_intr_mbox.get_count() ^ 1;
 	case SPU_RdInMbox:        return ch_in_mbox.get_count();
-	case MFC_RdTagStat:       return ch_tag_stat.get_count();
 	case MFC_RdListStallStat: return ch_stall_stat.get_count();
 	case MFC_WrTagUpdate:     return ch_tag_upd == 0;
 	case SPU_RdSigNotify1:    return ch_snr1.get_count();
@@ -1646,6 +1891,11 @@ u32 spu_thread::get_ch_count(u32 ch)
 	case MFC_RdAtomicStat:    return ch_atomic_stat.get_count();
 	case SPU_RdEventStat:     return get_events() != 0;
 	case MFC_Cmd:             return 16 - mfc_size;
+	case MFC_RdTagStat:
+	{
+		do_mfc_async_update(false);
+		return ch_tag_stat.get_count();
+	}
 	}
 
 	fmt::throw_exception("Unknown/illegal channel (ch=%d [%s])" HERE, ch, ch < 128 ? spu_ch_name[ch] : "???");
@@ -1715,6 +1965,12 @@ s64 spu_thread::get_ch_value(u32 ch)
 
 	case MFC_RdTagStat:
 	{
+		if (!ch_tag_stat.get_count())
+		{
+			// Resolve pending tag status update if it depends on asynchronous transfers
+			do_mfc_async_update(true);
+		}
+
 		if (ch_tag_stat.get_count())
 		{
 			u32 out = ch_tag_stat.get_value();
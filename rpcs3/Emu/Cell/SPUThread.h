@@ -7,6 +7,7 @@
 #include "MFC.h"
 
 #include <map>
+#include <deque>
 
 struct lv2_event_queue;
 struct lv2_spu_group;
@@ -494,6 +495,40 @@ public:
 	}
 };
 
+class spu_thread;
+
+// Asynchronous MFC transfer worker (one per SPU thread group)
+class spu_dma_worker
+{
+	struct job
+	{
+		spu_thread* spu;
+		spu_mfc_cmd cmd;
+		u64 seq;
+	};
+
+	shared_mutex m_mutex;
+
+	cond_variable m_cond;
+
+	// Transfers waiting for processing (in issue order)
+	std::deque<job> m_jobs;
+
+	bool m_stop = false;
+
+	named_thread<std::function<void()>> m_thread;
+
+	void work();
+
+public:
+	spu_dma_worker(const std::string& name);
+
+	~spu_dma_worker();
+
+	// Queue transfer, its completion is published in spu_thread::mfc_async_done
+	void push(spu_thread& spu, const spu_mfc_cmd& cmd, u64 seq);
+};
+
 class spu_thread : public cpu_thread
 {
 public:
@@ -528,6 +563,13 @@ public:
 	u32 mfc_fence = -1;
 	atomic_t<u32> mfc_prxy_mask;
 
+	// Asynchronous MFC state (transfers handed to the group DMA worker)
+	std::array<u64, 32> mfc_async_seq{}; // Last transfer issued for each tag
+	u64 mfc_async_last = 0; // Last transfer issued
+	atomic_t<u64> mfc_async_done{0}; // Last transfer completed
+
+	lv2_wait_link lv2_link; // Event queue links
+
 	// Reservation Data
 	u64 rtime = 0;
 	std::array<u128, 8> rdata{};
@@ -578,6 +620,7 @@ public:
 	u64 block_counter = 0;
 	u64 block_recover = 0;
 	u64 block_failure = 0;
+	u32 interp_stop_pc = -1; // Tiered mode: pc where the interpreter stopped inside a block (not an entry point)
 
 	std::array<v128, 0x4000> stack_mirror; // Return address information
 
@@ -588,6 +631,10 @@ public:
 	void do_putlluc(const spu_mfc_cmd& args);
 	void do_mfc(bool wait = true);
 	u32 get_mfc_completed();
+	bool do_mfc_async(const spu_mfc_cmd& args);
+	void do_mfc_async_wait(u64 seq);
+	void do_mfc_async_update(bool wait);
+	u32 get_mfc_async_pending();
 
 	bool process_mfc_cmd();
 	u32 get_events(bool waiting = false);
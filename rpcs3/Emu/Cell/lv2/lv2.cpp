@@ -997,6 +997,206 @@ extern ppu_function_t ppu_get_syscall(u64 code)
 
 extern u64 get_system_time();
 
+// Hierarchical timer wheel: O(1) insertion and removal, expiration cost proportional to elapsed ticks
+struct lv2_timer_wheel
+{
+	static constexpr u32 slot_bits = 6;
+	static constexpr u32 slot_count = 1 << slot_bits;
+	static constexpr u32 level_count = 4;
+
+	// Tick duration: 1024 µs (all levels cover about 4.8 hours, longer timeouts are cascaded again)
+	static constexpr u32 tick_shift = 10;
+
+	struct entry
+	{
+		cpu_thread* thread;
+		u64 until; // In ticks
+		u32 level;
+		entry* prev;
+		entry* next;
+	};
+
+	shared_mutex mutex;
+
+	// Slot list heads (circular lists)
+	std::array<std::array<entry, slot_count>, level_count> slots;
+
+	// Amount of entries per level
+	std::array<u32, level_count> counts{};
+
+	// Registered threads
+	std::unordered_map<cpu_thread*, entry> entries;
+
+	// Next tick to process
+	u64 current = 0;
+
+	lv2_timer_wheel()
+	{
+		for (auto& level : slots)
+		{
+			for (auto& head : level)
+			{
+				head.prev = &head;
+				head.next = &head;
+			}
+		}
+	}
+
+	void link(entry& e)
+	{
+		// Expired entries go to the current slot
+		const u64 until = std::max(e.until, current);
+
+		// Find the lowest level whose slot range contains the tick
+		u32 level = 0;
+
+		while (level < level_count && (until ^ current) >> (slot_bits * (level + 1)))
+		{
+			level++;
+		}
+
+		u64 index;
+
+		if (level == level_count)
+		{
+			// Too far: use the last slot of the top level, it will be cascaded again
+			level = level_count - 1;
+			index = (current >> (slot_bits * level)) + slot_count - 1;
+		}
+		else
+		{
+			index = until >> (slot_bits * level);
+		}
+
+		entry& head = slots[level][index % slot_count];
+		e.level = level;
+		e.prev = head.prev;
+		e.next = &head;
+		head.prev->next = &e;
+		head.prev = &e;
+		counts[level]++;
+	}
+
+	void unlink(entry& e)
+	{
+		e.prev->next = e.next;
+		e.next->prev = e.prev;
+		counts[e.level]--;
+	}
+
+	void add(cpu_thread* thread, u64 until)
+	{
+		const auto [found, ok] = entries.try_emplace(thread);
+
+		if (!ok)
+		{
+			unlink(found->second);
+		}
+
+		found->second.thread = thread;
+		found->second.until = until >> tick_shift;
+		link(found->second);
+	}
+
+	void remove(cpu_thread* thread)
+	{
+		const auto found = entries.find(thread);
+
+		if (found != entries.end())
+		{
+			unlink(found->second);
+			entries.erase(found);
+		}
+	}
+
+	// Remove expired entries, call func(cpu_thread*) for each
+	template <typename F>
+	void expire(u64 now, F&& func)
+	{
+		now >>= tick_shift;
+
+		while (current <= now)
+		{
+			// Skip ticks while the lower levels are empty
+			u32 level = 0;
+
+			while (level < level_count && !counts[level])
+			{
+				level++;
+			}
+
+			if (level == level_count)
+			{
+				current = now + 1;
+				break;
+			}
+
+			const u64 mask = (u64{1} << (slot_bits * level)) - 1;
+
+			if (current & mask)
+			{
+				current = std::min((current | mask) + 1, now + 1);
+				continue;
+			}
+
+			// Move entries from higher level slots starting at this tick to lower levels
+			for (u32 i = level_count - 1; i > 0; i--)
+			{
+				if (current & ((u64{1} << (slot_bits * i)) - 1))
+				{
+					continue;
+				}
+
+				entry& head = slots[i][(current >> (slot_bits * i)) % slot_count];
+
+				for (entry* e = head.next; e != &head;)
+				{
+					entry* next = e->next;
+					unlink(*e);
+					link(*e);
+					e = next;
+				}
+			}
+
+			entry& head = slots[0][current % slot_count];
+
+			while (head.next != &head)
+			{
+				const auto thread = head.next->thread;
+				remove(thread);
+				func(thread);
+			}
+
+			current++;
+		}
+	}
+
+	void clear()
+	{
+		for (auto& level : slots)
+		{
+			for (auto& head : level)
+			{
+				head.prev = &head;
+				head.next = &head;
+			}
+		}
+
+		counts = {};
+		entries.clear();
+	}
+};
+
+lv2_wait_link& lv2_wait_queue::link(cpu_thread* cpu)
+{
+	if (cpu->id_type() == 1)
+	{
+		return static_cast<ppu_thread*>(cpu)->lv2_link;
+	}
+
+	return static_cast<spu_thread*>(cpu)->lv2_link;
+}
+
 DECLARE(lv2_obj::g_mutex);
 DECLARE(lv2_obj::g_ppu);
 DECLARE(lv2_obj::g_pending);
@@ -1004,8 +1204,16 @@ DECLARE(lv2_obj::g_waiting);
 
 void lv2_obj::sleep_timeout(cpu_thread& thread, u64 timeout)
 {
-	std::lock_guard lock(g_mutex);
+	{
+		std::lock_guard lock(g_mutex);
+		_sleep_timeout(thread, timeout);
+	}
 
+	expire_timeouts();
+}
+
+void lv2_obj::_sleep_timeout(cpu_thread& thread, u64 timeout)
+{
 	const u64 start_time = get_system_time();
 
 	if (auto ppu = static_cast<ppu_thread*>(thread.id_type() == 1 ? &thread : nullptr))
@@ -1038,19 +1246,9 @@ void lv2_obj::sleep_timeout(cpu_thread& thread, u64 timeout)
 
 	if (timeout)
 	{
-		const u64 wait_until = start_time + timeout;
-
-		// Register timeout if necessary
-		for (auto it = g_waiting.begin(), end = g_waiting.end(); it != end; it++)
-		{
-			if (it->first > wait_until)
-			{
-				g_waiting.emplace(it, wait_until, &thread);
-				return;
-			}
-		}
-
-		g_waiting.emplace_back(wait_until, &thread);
+		// Register timeout
+		std::lock_guard lock(g_waiting.mutex);
+		g_waiting.add(&thread, start_time + timeout);
 	}
 
 	schedule_all();
@@ -1061,8 +1259,16 @@ void lv2_obj::awake(cpu_thread& cpu, u32 prio)
 	// Check thread type
 	if (cpu.id_type() != 1) return;
 
-	std::lock_guard lock(g_mutex);
+	{
+		std::lock_guard lock(g_mutex);
+		_awake(cpu, prio);
+	}
+
+	expire_timeouts();
+}
 
+void lv2_obj::_awake(cpu_thread& cpu, u32 prio)
+{
 	if (prio < INT32_MAX)
 	{
         // Priority set
@@ -1111,14 +1317,8 @@ void lv2_obj::awake(cpu_thread& cpu, u32 prio)
 			g_ppu.insert(g_ppu.cbegin() + i, &static_cast<ppu_thread&>(cpu));
 
 			// Unregister timeout if necessary
-			for (auto it = g_waiting.cbegin(), end = g_waiting.cend(); it != end; it++)
-			{
-				if (it->second == &cpu)
-				{
-					g_waiting.erase(it);
-					break;
-				}
-			}
+			std::lock_guard lock(g_waiting.mutex);
+			g_waiting.remove(&cpu);
 
 			break;
 		}
@@ -1149,6 +1349,8 @@ void lv2_obj::cleanup()
 {
 	g_ppu.clear();
 	g_pending.clear();
+
+	std::lock_guard lock(g_waiting.mutex);
 	g_waiting.clear();
 }
 
@@ -1174,21 +1376,15 @@ void lv2_obj::schedule_all()
 			}
 		}
 	}
+}
+
+void lv2_obj::expire_timeouts()
+{
+	std::lock_guard lock(g_waiting.mutex);
 
 	// Check registered timeouts
-	while (!g_waiting.empty())
+	g_waiting.expire(get_system_time(), [](cpu_thread* thread)
 	{
-		auto& pair = g_waiting.front();
-
-		if (pair.first <= get_system_time())
-		{
-			pair.second->notify();
-			g_waiting.pop_front();
-		}
-		else
-		{
-			// The list is sorted so assume no more timeouts
-			break;
-		}
-	}
+		thread->notify();
+	});
 }
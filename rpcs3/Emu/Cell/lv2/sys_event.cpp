@@ -171,7 +171,8 @@ error_code sys_event_queue_destroy(ppu_thread& ppu, u32 equeue_id, s32 mode)
 	{
 		std::lock_guard lock(queue->mutex);
 
-		for (auto cpu : queue->sq)
+		// Unlink each thread before waking it up
+		while (const auto cpu = queue->sq.pop_front())
 		{
 			if (queue->type == SYS_PPU_QUEUE)
 			{
@@ -262,7 +262,7 @@ error_code sys_event_flag_set(u32 id, u64 bitptn)
 		// Sort sleep queue in required order
 		if (flag->protocol != SYS_SYNC_FIFO)
 		{
-			std::stable_sort(flag->sq.begin(), flag->sq.end(), [](cpu_thread* a, cpu_thread* b)
+			flag->sq.stable_sort([](cpu_thread* a, cpu_thread* b)
 			{
 				return static_cast<ppu_thread*>(a)->prio < static_cast<ppu_thread*>(b)->prio;
 			});
@@ -300,22 +300,26 @@ error_code sys_event_flag_set(u32 id, u64 bitptn)
 			return CELL_OK;
 		}
 
-		// Remove waiters
-		const auto tail = std::remove_if(flag->sq.begin(), flag->sq.end(), [&](cpu_thread* cpu)
-		{
-			auto& ppu = static_cast<ppu_thread&>(*cpu);
+		// Remove waiters (awake them only after unlinking, they may wait on another object right away)
+		std::vector<cpu_thread*> woken;
+		woken.reserve(count);
 
-			if (ppu.gpr[3] == CELL_OK)
+		flag->sq.remove_if([&](cpu_thread* cpu)
+		{
+			if (static_cast<ppu_thread&>(*cpu).gpr[3] == CELL_OK)
 			{
 				flag->waiters--;
-				flag->awake(ppu);
+				woken.push_back(cpu);
 				return true;
 			}
 
 			return false;
 		});
 
-		flag->sq.erase(tail, flag->sq.end());
+		for (auto cpu : woken)
+		{
+			flag->awake(*cpu);
+		}
 	}
 
 	return CELL_OK;
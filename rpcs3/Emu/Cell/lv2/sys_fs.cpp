@@ -65,21 +65,21 @@ lv2_fs_mount_point* lv2_fs_object::get_mp(const char* filename)
 	return &g_mp_sys_dev_hdd0;
 }
 
-u64 lv2_file::op_read(vm::ptr<void> buf, u64 size)
+u64 lv2_file::op_read(vm::ptr<void> buf, u64 size, u64 offset)
 {
 	// Copy data from intermediate buffer (avoid passing vm pointer to a native API)
 	std::unique_ptr<u8[]> local_buf(new u8[size]);
-	const u64 result = file.read(local_buf.get(), size);
+	const u64 result = file.read_at(offset, local_buf.get(), size);
 	std::memcpy(buf.get_ptr(), local_buf.get(), result);
 	return result;
 }
 
-u64 lv2_file::op_write(vm::cptr<void> buf, u64 size)
+u64 lv2_file::op_write(vm::cptr<void> buf, u64 size, u64 offset)
 {
 	// Copy data to intermediate buffer (avoid passing vm pointer to a native API)
 	std::unique_ptr<u8[]> local_buf(new u8[size]);
 	std::memcpy(local_buf.get(), buf.get_ptr(), size);
-	return file.write(local_buf.get(), size);
+	return file.write_at(offset, local_buf.get(), size);
 }
 
 struct lv2_file::file_view : fs::file_base
@@ -111,10 +111,9 @@ struct lv2_file::file_view : fs::file_base
 
 	u64 read(void* buffer, u64 size) override
 	{
-		const u64 old_pos = m_file->file.pos();
-		const u64 new_pos = m_file->file.seek(m_off + m_pos);
-		const u64 result = m_file->file.read(buffer, size);
-		verify(HERE), old_pos == m_file->file.seek(old_pos);
+		std::lock_guard lock(m_file->mutex);
+
+		const u64 result = m_file->file.read_at(m_off + m_pos, buffer, size);
 
 		m_pos += result;
 		return result;
@@ -395,9 +394,11 @@ error_code sys_fs_read(u32 fd, vm::ptr<void> buf, u64 nbytes, vm::ptr<u64> nread
 		return CELL_EBADF;
 	}
 
-	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard lock(file->mutex);
 
-	*nread = file->op_read(buf, nbytes);
+	const u64 result = file->op_read(buf, nbytes, file->pos);
+	file->pos += result;
+	*nread = result;
 
 	return CELL_OK;
 }
@@ -413,14 +414,17 @@ error_code sys_fs_write(u32 fd, vm::cptr<void> buf, u64 nbytes, vm::ptr<u64> nwr
 		return CELL_EBADF;
 	}
 
-	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard lock(file->mutex);
 
 	if (file->lock)
 	{
 		return CELL_EBUSY;
 	}
 
-	*nwrite = file->op_write(buf, nbytes);
+	const u64 offset = file->flags & CELL_FS_O_APPEND ? file->file.size() : file->pos;
+	const u64 result = file->op_write(buf, nbytes, offset);
+	file->pos = offset + result;
+	*nwrite = result;
 
 	return CELL_OK;
 }
@@ -692,7 +696,7 @@ error_code sys_fs_fstat(u32 fd, vm::ptr<CellFsStat> sb)
 		return CELL_EBADF;
 	}
 
-	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard lock(file->mutex);
 
 	const fs::stat_t& info = file->file.stat();
 
@@ -922,21 +926,16 @@ error_code sys_fs_fcntl(u32 fd, u32 op, vm::ptr<void> _arg, u32 _size)
 			return CELL_EBADF;
 		}
 
-		std::lock_guard lock(file->mp->mutex);
+		std::lock_guard lock(file->mutex);
 
 		if (op == 0x8000000b && file->lock)
 		{
 			return CELL_EBUSY;
 		}
 
-		const u64 old_pos = file->file.pos();
-		const u64 new_pos = file->file.seek(arg->offset);
-
 		arg->out_size = op == 0x8000000a
-			? file->op_read(arg->buf, arg->size)
-			: file->op_write(arg->buf, arg->size);
-
-		verify(HERE), old_pos == file->file.seek(old_pos);
+			? file->op_read(arg->buf, arg->size, arg->offset)
+			: file->op_write(arg->buf, arg->size, arg->offset);
 
 		arg->out_code = CELL_OK;
 		return CELL_OK;
@@ -1269,21 +1268,19 @@ error_code sys_fs_lseek(u32 fd, s64 offset, s32 whence, vm::ptr<u64> pos)
 		return CELL_EBADF;
 	}
 
-	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard lock(file->mutex);
 
-	const u64 result = file->file.seek(offset, static_cast<fs::seek_mode>(whence));
+	const s64 result =
+		whence == 0 ? offset :
+		whence == 1 ? offset + file->pos :
+		offset + file->file.size();
 
-	if (result == -1)
+	if (result < 0)
 	{
-		switch (auto error = fs::g_tls_error)
-		{
-		case fs::error::inval: return CELL_EINVAL;
-		default: sys_fs.error("sys_fs_lseek(): unknown error %s", error);
-		}
-
-		return CELL_EIO; // ???
+		return CELL_EINVAL;
 	}
 
+	file->pos = result;
 	*pos = result;
 	return CELL_OK;
 }
@@ -1400,7 +1397,7 @@ error_code sys_fs_ftruncate(u32 fd, u64 size)
 		return CELL_EBADF;
 	}
 
-	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard lock(file->mutex);
 
 	if (file->lock)
 	{
@@ -1411,7 +1408,7 @@ error_code sys_fs_ftruncate(u32 fd, u64 size)
 	{
 		const u64 fsize = file->file.size();
 
-		if (size > fsize && !file->file.write(std::vector<u8>(size - fsize)))
+		if (size > fsize && file->file.write_at(fsize, std::vector<u8>(size - fsize).data(), size - fsize) != size - fsize)
 		{
 			return CELL_ENOSPC;
 		}
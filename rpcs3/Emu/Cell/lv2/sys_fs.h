@@ -2,6 +2,7 @@
 
 #include "Emu/Memory/vm.h"
 #include "Emu/Cell/ErrorCodes.h"
+#include "Utilities/mutex.h"
 
 // Open Flags
 enum : s32
@@ -170,6 +171,12 @@ struct lv2_file final : lv2_fs_object
 	// Stream lock
 	atomic_t<u32> lock{0};
 
+	// File mutex (I/O and position, the mount point mutex is only used for namespace operations)
+	shared_mutex mutex;
+
+	// Current position (the position of the host file is not used)
+	u64 pos = 0;
+
 	lv2_file(const char* filename, fs::file&& file, s32 mode, s32 flags)
 		: lv2_fs_object(lv2_fs_object::get_mp(filename), filename)
 		, file(std::move(file))
@@ -186,11 +193,11 @@ struct lv2_file final : lv2_fs_object
 	{
 	}
 
-	// File reading with intermediate buffer
-	u64 op_read(vm::ptr<void> buf, u64 size);
+	// File reading with intermediate buffer at the specified position
+	u64 op_read(vm::ptr<void> buf, u64 size, u64 offset);
 
-	// File writing with intermediate buffer
-	u64 op_write(vm::cptr<void> buf, u64 size);
+	// File writing with intermediate buffer at the specified position
+	u64 op_write(vm::cptr<void> buf, u64 size, u64 offset);
 
 	// For MSELF support
 	struct file_view;
@@ -59,7 +59,7 @@ struct lv2_lwmutex final : lv2_obj
 
 	shared_mutex mutex;
 	atomic_t<s32> signaled{0};
-	std::deque<cpu_thread*> sq;
+	lv2_wait_queue sq;
 
 	lv2_lwmutex(u32 protocol, vm::ptr<sys_lwmutex_t> control, u64 name)
 		: protocol(protocol)
@@ -29,8 +29,8 @@ struct lv2_rwlock final : lv2_obj
 
 	shared_mutex mutex;
 	atomic_t<s64> owner{0};
-	std::deque<cpu_thread*> rq;
-	std::deque<cpu_thread*> wq;
+	lv2_wait_queue rq;
+	lv2_wait_queue wq;
 
 	lv2_rwlock(u32 protocol, u32 shared, u64 key, s32 flags, u64 name)
 		: protocol(protocol)
@@ -232,6 +232,11 @@ error_code sys_spu_thread_initialize(vm::ptr<u32> thread, u32 group_id, u32 spu_
 		sys_spu.todo("Unimplemented SPU Thread options (0x%x)", option);
 	}
 
+	if (g_cfg.core.spu_async_mfc && !group->dma)
+	{
+		group->dma = std::make_unique<spu_dma_worker>(group->name);
+	}
+
 	const vm::addr_t ls_addr{verify("SPU LS" HERE, vm::alloc(0x40000, vm::main))};
 
 	const u32 tid = idm::import<named_thread<spu_thread>>([&]()
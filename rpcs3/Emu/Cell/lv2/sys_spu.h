@@ -239,6 +239,8 @@ struct lv2_spu_group
 	std::weak_ptr<lv2_event_queue> ep_exception; // TODO: SYS_SPU_THREAD_GROUP_EVENT_EXCEPTION
 	std::weak_ptr<lv2_event_queue> ep_sysmodule; // TODO: SYS_SPU_THREAD_GROUP_EVENT_SYSTEM_MODULE
 
+	std::unique_ptr<spu_dma_worker> dma; // Asynchronous MFC worker (created with the first thread if enabled)
+
 	lv2_spu_group(std::string name, u32 num, s32 prio, s32 type, u32 ct)
 		: id(idm::last_id())
 		, name(name)
@@ -55,6 +55,194 @@ enum
 	SYS_SYNC_ATTR_ADAPTIVE_MASK  = 0xf000,
 };
 
+// Timer wheel for lv2 timeouts (defined in lv2.cpp)
+struct lv2_timer_wheel;
+
+// Intrusive FIFO of waiting threads (links are stored in the thread objects, see lv2_wait_link)
+class lv2_wait_queue
+{
+	cpu_thread* m_head = nullptr;
+	cpu_thread* m_tail = nullptr;
+	std::size_t m_size = 0;
+
+public:
+	// Get links of the thread (PPU or SPU)
+	static lv2_wait_link& link(cpu_thread* cpu);
+
+	lv2_wait_queue() = default;
+
+	lv2_wait_queue(const lv2_wait_queue&) = delete;
+
+	lv2_wait_queue& operator=(const lv2_wait_queue&) = delete;
+
+	class iterator
+	{
+		cpu_thread* m_ptr;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = cpu_thread*;
+		using difference_type = std::ptrdiff_t;
+		using pointer = cpu_thread* const*;
+		using reference = cpu_thread* const&;
+
+		explicit iterator(cpu_thread* ptr = nullptr)
+			: m_ptr(ptr)
+		{
+		}
+
+		cpu_thread* operator*() const
+		{
+			return m_ptr;
+		}
+
+		iterator& operator++()
+		{
+			m_ptr = link(m_ptr).next;
+			return *this;
+		}
+
+		iterator operator++(int)
+		{
+			iterator old = *this;
+			++*this;
+			return old;
+		}
+
+		bool operator==(const iterator& rhs) const
+		{
+			return m_ptr == rhs.m_ptr;
+		}
+
+		bool operator!=(const iterator& rhs) const
+		{
+			return m_ptr != rhs.m_ptr;
+		}
+	};
+
+	iterator begin() const
+	{
+		return iterator(m_head);
+	}
+
+	iterator end() const
+	{
+		return iterator();
+	}
+
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	cpu_thread* front() const
+	{
+		return m_head;
+	}
+
+	// Append the thread (it must not be in any queue)
+	void emplace_back(cpu_thread* cpu)
+	{
+		auto& l = link(cpu);
+		verify(HERE), !l.queue;
+		l.prev = m_tail;
+		l.next = nullptr;
+		l.queue = this;
+
+		if (m_tail)
+		{
+			link(m_tail).next = cpu;
+		}
+		else
+		{
+			m_head = cpu;
+		}
+
+		m_tail = cpu;
+		m_size++;
+	}
+
+	// Remove the thread if it's contained in this queue (O(1))
+	bool remove(cpu_thread* cpu)
+	{
+		auto& l = link(cpu);
+
+		if (l.queue != this)
+		{
+			return false;
+		}
+
+		(l.prev ? link(l.prev).next : m_head) = l.next;
+		(l.next ? link(l.next).prev : m_tail) = l.prev;
+		l = {};
+		m_size--;
+		return true;
+	}
+
+	cpu_thread* pop_front()
+	{
+		const auto cpu = m_head;
+
+		if (cpu)
+		{
+			// Links of a queued thread must not be reused before it's unlinked
+			verify(HERE), remove(cpu);
+		}
+
+		return cpu;
+	}
+
+	// Remove all threads for which pred returns true, preserving the order of others (pred must not wake them up)
+	template <typename F>
+	std::size_t remove_if(F&& pred)
+	{
+		std::size_t count = 0;
+
+		for (auto cpu = m_head; cpu;)
+		{
+			const auto next = link(cpu).next;
+
+			if (pred(cpu))
+			{
+				verify(HERE), remove(cpu);
+				count++;
+			}
+
+			cpu = next;
+		}
+
+		return count;
+	}
+
+	// Reorder threads (rare operation)
+	template <typename F>
+	void stable_sort(F&& pred)
+	{
+		std::vector<cpu_thread*> list(begin(), end());
+		std::stable_sort(list.begin(), list.end(), std::forward<F>(pred));
+		clear();
+
+		for (auto cpu : list)
+		{
+			emplace_back(cpu);
+		}
+	}
+
+	// Unlink all threads
+	void clear()
+	{
+		while (m_head)
+		{
+			pop_front();
+		}
+	}
+};
+
 // Base class for some kernel objects (shared set of 8192 objects).
 struct lv2_obj
 {
@@ -79,6 +267,43 @@ struct lv2_obj
 		return false;
 	}
 
+	static bool unqueue(lv2_wait_queue& queue, cpu_thread* object)
+	{
+		return queue.remove(object);
+	}
+
+	template <typename E>
+	static cpu_thread* schedule(lv2_wait_queue& queue, u32 protocol)
+	{
+		if (queue.empty())
+		{
+			return nullptr;
+		}
+
+		if (protocol == SYS_SYNC_FIFO)
+		{
+			return queue.pop_front();
+		}
+
+		// Priority may change while waiting, so it's selected on removal
+		u32 prio = -1;
+		cpu_thread* res = queue.front();
+
+		for (auto cpu : queue)
+		{
+			const u32 _prio = static_cast<E*>(cpu)->prio;
+
+			if (_prio < prio)
+			{
+				res = cpu;
+				prio = _prio;
+			}
+		}
+
+		queue.remove(res);
+		return res;
+	}
+
 	template <typename E, typename T>
 	static T* schedule(std::deque<T*>& queue, u32 protocol)
 	{
@@ -223,8 +448,15 @@ private:
 	// Waiting for the response from
 	static std::deque<class cpu_thread*> g_pending;
 
-	// Scheduler queue for timeouts (wait until -> thread)
-	static std::deque<std::pair<u64, class cpu_thread*>> g_waiting;
+	// Scheduler queue for timeouts (wait until -> thread), has its own mutex
+	static lv2_timer_wheel g_waiting;
+
+	static void _sleep_timeout(cpu_thread&, u64 timeout);
+
+	static void _awake(cpu_thread&, u32 prio);
 
 	static void schedule_all();
+
+	// Notify threads with expired timeouts (g_mutex must not be locked)
+	static void expire_timeouts();
 };
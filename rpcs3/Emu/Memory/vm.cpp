@@ -57,30 +57,75 @@ namespace vm
 	// Memory mutex acknowledgement
 	thread_local atomic_t<cpu_thread*>* g_tls_locked = nullptr;
 
-	// Currently locked address
-	atomic_t<u32> g_addr_lock = 0;
+	// Memory mutex: passive lock slot (one cache line per registered thread)
+	struct alignas(64) passive_slot
+	{
+		atomic_t<cpu_thread*> cpu;
+	};
 
 	// Memory mutex: passive locks
-	std::array<atomic_t<cpu_thread*>, 4> g_locks{};
-	std::array<atomic_t<u64>, 6> g_range_locks{};
+	std::array<passive_slot, 64> g_locks{};
+
+	// Amount of passive lock slots which have ever been used (scanned by writers)
+	atomic_t<u32> g_locks_used{0};
+
+	// Next preferred passive lock slot for a new thread
+	atomic_t<u32> g_locks_next{0};
+
+	// Preferred passive lock slot of the current thread
+	thread_local u32 g_tls_slot = g_locks_next++ % g_locks.size();
+
+	// Address range covered by one range lock shard (range locks can't be bigger)
+	constexpr u32 range_shard_size = 0x100000;
+
+	// Range locks and the locked address for address ranges selected by (addr / range_shard_size)
+	struct alignas(64) range_shard
+	{
+		// Currently locked address
+		atomic_t<u32> addr_lock;
+
+		std::array<atomic_t<u64>, 6> locks;
+	};
+
+	std::array<range_shard, 16> g_range_shards{};
+
+	// Shard with the currently locked address (protected by g_mutex)
+	range_shard* g_locked_shard = nullptr;
+
+	static range_shard& _get_range_shard(u32 addr)
+	{
+		return g_range_shards[addr / range_shard_size % g_range_shards.size()];
+	}
 
 	static void _register_lock(cpu_thread* _cpu)
 	{
-		for (u32 i = 0;; i = (i + 1) % g_locks.size())
+		for (u32 i = g_tls_slot;; i = (i + 1) % g_locks.size())
 		{
-			if (!g_locks[i] && g_locks[i].compare_and_swap_test(nullptr, _cpu))
+			auto& slot = g_locks[i].cpu;
+
+			if (!slot && slot.compare_and_swap_test(nullptr, _cpu))
 			{
-				g_tls_locked = g_locks.data() + i;
+				if (UNLIKELY(g_locks_used <= i))
+				{
+					// Writers must observe the slot before checking the mutex
+					g_locks_used.atomic_op([&](u32& used)
+					{
+						used = std::max(used, i + 1);
+					});
+				}
+
+				g_tls_slot = i;
+				g_tls_locked = &slot;
 				return;
 			}
 		}
 	}
 
-	static atomic_t<u64>* _register_range_lock(const u64 lock_info)
+	static atomic_t<u64>* _register_range_lock(range_shard& shard, const u64 lock_info)
 	{
 		while (true)
 		{
-			for (auto& lock : g_range_locks)
+			for (auto& lock : shard.locks)
 			{
 				if (!lock && lock.compare_and_swap_test(0, lock_info))
 				{
@@ -121,14 +166,20 @@ namespace vm
 			return addr > target || end <= target;
 		};
 
+		// The range is registered in the shard of its beginning, it may also cover the next shard
+		verify(HERE), end - addr <= range_shard_size;
+
+		auto& shard = _get_range_shard(addr);
+		auto& last = _get_range_shard(end - 1);
+
 		atomic_t<u64>* _ret;
 
-		if (LIKELY(test_addr(g_addr_lock.load(), addr, end)))
+		if (LIKELY(test_addr(shard.addr_lock.load(), addr, end) && test_addr(last.addr_lock.load(), addr, end)))
 		{
 			// Optimistic path (hope that address range is not locked)
-			_ret = _register_range_lock((u64)end << 32 | addr);
+			_ret = _register_range_lock(shard, (u64)end << 32 | addr);
 
-			if (LIKELY(test_addr(g_addr_lock.load(), addr, end)))
+			if (LIKELY(test_addr(shard.addr_lock.load(), addr, end) && test_addr(last.addr_lock.load(), addr, end)))
 			{
 				return _ret;
 			}
@@ -138,7 +189,7 @@ namespace vm
 
 		{
 			::reader_lock lock(g_mutex);
-			_ret = _register_range_lock((u64)end << 32 | addr);
+			_ret = _register_range_lock(shard, (u64)end << 32 | addr);
 		}
 
 		return _ret;
@@ -160,11 +211,11 @@ namespace vm
 
 	void cleanup_unlock(cpu_thread& cpu) noexcept
 	{
-		for (u32 i = 0; i < g_locks.size(); i++)
+		for (u32 i = 0, used = g_locks_used; i < used; i++)
 		{
-			if (g_locks[i] == &cpu)
+			if (g_locks[i].cpu == &cpu)
 			{
-				g_locks[i].compare_and_swap_test(&cpu, nullptr);
+				g_locks[i].cpu.compare_and_swap_test(&cpu, nullptr);
 				return;
 			}
 		}
@@ -240,41 +291,49 @@ namespace vm
 
 		if (addr)
 		{
-			for (auto& lock : g_locks)
+			// New readers see the locked mutex after registration
+			const u32 used = g_locks_used;
+
+			for (u32 i = 0; i < used; i++)
 			{
-				if (cpu_thread* ptr = lock)
+				if (cpu_thread* ptr = g_locks[i].cpu)
 				{
 					ptr->state.test_and_set(cpu_flag::memory);
 				}
 			}
 
-			g_addr_lock = addr;
+			g_locked_shard = &_get_range_shard(addr);
+			g_locked_shard->addr_lock = addr;
 
-			for (auto& lock : g_range_locks)
+			// Ranges containing addr begin in its shard or in the previous one
+			for (auto shard : {g_locked_shard, &_get_range_shard(addr - range_shard_size)})
 			{
-				while (true)
+				for (auto& lock : shard->locks)
 				{
-					const u64 value = lock;
-
-					// Test beginning address
-					if (static_cast<u32>(value) > addr)
+					while (true)
 					{
-						break;
-					}
+						const u64 value = lock;
 
-					// Test end address
-					if (static_cast<u32>(value >> 32) <= addr)
-					{
-						break;
-					}
+						// Test beginning address
+						if (static_cast<u32>(value) > addr)
+						{
+							break;
+						}
 
-					_mm_pause();
+						// Test end address
+						if (static_cast<u32>(value >> 32) <= addr)
+						{
+							break;
+						}
+
+						_mm_pause();
+					}
 				}
 			}
 
-			for (auto& lock : g_locks)
+			for (u32 i = 0; i < used; i++)
 			{
-				while (cpu_thread* ptr = lock)
+				while (cpu_thread* ptr = g_locks[i].cpu)
 				{
 					if (ptr->is_stopped())
 					{
@@ -295,7 +354,12 @@ namespace vm
 
 	writer_lock::~writer_lock()
 	{
-		g_addr_lock.release(0);
+		if (g_locked_shard)
+		{
+			g_locked_shard->addr_lock.release(0);
+			g_locked_shard = nullptr;
+		}
+
 		g_mutex.unlock();
 	}
 
@@ -20,15 +20,8 @@ namespace rsx
 				u64 data_hash = XXH64(data.data.data(), data.data.size(), 0);
 				block.data_state = data_hash;
 
-				auto it = frame_capture.memory_data_map.find(data_hash);
-				if (it != frame_capture.memory_data_map.end())
-				{
-					if (it->second.data != data.data)
-						// screw this
-						fmt::throw_exception("Memory map hash collision detected...cant capture");
-				}
-				else
-					frame_capture.memory_data_map.insert(std::make_pair(data_hash, std::move(data)));
+				// Contents go straight to the capture file, once per capture
+				frame_capture_writer->add_data(data_hash, data.data);
 
 				u64 block_hash = XXH64(&block, sizeof(frame_capture_data::memory_block), 0);
 				mem_changes.insert(block_hash);
@@ -0,0 +1,598 @@
+#include "stdafx.h"
+#include "rsx_capture_stream.h"
+
+#include <cereal/archives/binary.hpp>
+#include <zlib.h>
+
+#include <sstream>
+
+namespace rsx
+{
+	namespace
+	{
+		// Size of data chunks before compression
+		constexpr u32 data_chunk_size = 16 * 1024 * 1024;
+
+		// Uncompressed chunk data the game may get ahead of the disk by
+		constexpr u64 max_queued_bytes = 256 * 1024 * 1024;
+
+		struct byte_writer
+		{
+			std::vector<u8>& data;
+
+			void put_varint(u64 value)
+			{
+				while (value >= 0x80)
+				{
+					data.push_back(u8(value) | 0x80);
+					value >>= 7;
+				}
+
+				data.push_back(u8(value));
+			}
+
+			void put(const void* ptr, std::size_t size)
+			{
+				data.insert(data.end(), static_cast<const u8*>(ptr), static_cast<const u8*>(ptr) + size);
+			}
+
+			// Sorted ids as differences to the previous one
+			void put_id_list(const std::vector<u32>& ids)
+			{
+				put_varint(ids.size());
+
+				u32 last = 0;
+
+				for (u32 id : ids)
+				{
+					put_varint(id - last);
+					last = id;
+				}
+			}
+		};
+
+		struct byte_reader
+		{
+			const std::vector<u8>& data;
+			std::size_t pos = 0;
+
+			u64 get_varint()
+			{
+				u64 result = 0;
+
+				for (u32 shift = 0; shift < 64; shift += 7)
+				{
+					if (pos >= data.size())
+					{
+						break;
+					}
+
+					const u8 byte = data[pos++];
+					result |= u64{byte & 0x7fu} << shift;
+
+					if (!(byte & 0x80))
+					{
+						return result;
+					}
+				}
+
+				fmt::throw_exception("Capture stream: invalid chunk data" HERE);
+			}
+
+			const u8* get(std::size_t size)
+			{
+				if (size > data.size() - pos)
+				{
+					fmt::throw_exception("Capture stream: unexpected end of chunk" HERE);
+				}
+
+				const u8* ptr = data.data() + pos;
+				pos += size;
+				return ptr;
+			}
+
+			template <typename T>
+			void get(T& value)
+			{
+				std::memcpy(&value, get(sizeof(T)), sizeof(T));
+			}
+
+			void get_id_list(std::vector<u32>& ids)
+			{
+				ids.resize(get_varint());
+
+				u32 last = 0;
+
+				for (u32& id : ids)
+				{
+					id = last += u32(get_varint());
+				}
+			}
+		};
+	}
+
+	capture_stream_writer::capture_stream_writer(fs::file&& file, const std::string& path, const rsx_state& initial_state)
+		: m_file(std::move(file))
+		, m_path(path)
+	{
+		const u32 header[2]{FRAME_CAPTURE_MAGIC, FRAME_CAPTURE_STREAM_VERSION};
+		m_file.write(header, sizeof(header));
+
+		m_thread = std::make_unique<named_thread<std::function<void()>>>("RSX Capture Writer", [this]()
+		{
+			while (true)
+			{
+				pending_chunk chunk;
+				{
+					std::lock_guard lock(m_mutex);
+
+					if (m_queue.empty())
+					{
+						if (m_closing)
+						{
+							break;
+						}
+
+						m_cond.wait(m_mutex, 10000);
+						continue;
+					}
+
+					chunk = std::move(m_queue.front());
+					m_queue.pop_front();
+				}
+
+				write_chunk(chunk);
+
+				{
+					std::lock_guard lock(m_mutex);
+					m_queued_bytes -= chunk.data.size();
+				}
+
+				m_cond.notify_all();
+			}
+		});
+
+		std::stringstream os;
+		cereal::BinaryOutputArchive archive(os);
+		archive(initial_state);
+
+		const std::string& state = os.str();
+		submit(capture_stream::chunk_type::registers, std::vector<u8>(state.begin(), state.end()));
+	}
+
+	capture_stream_writer::~capture_stream_writer()
+	{
+		flush_data();
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_closing = true;
+		}
+
+		m_cond.notify_all();
+
+		// Joins once everything is written
+		m_thread.reset();
+	}
+
+	void capture_stream_writer::submit(capture_stream::chunk_type type, std::vector<u8>&& data, u32 arg0, u32 arg1)
+	{
+		{
+			std::lock_guard lock(m_mutex);
+
+			while (m_queued_bytes > max_queued_bytes)
+			{
+				m_cond.wait(m_mutex, 1000);
+			}
+
+			m_queued_bytes += data.size();
+			m_queue.emplace_back(pending_chunk{{type, 0, 0, arg0, arg1}, std::move(data)});
+		}
+
+		m_cond.notify_all();
+	}
+
+	void capture_stream_writer::write_chunk(pending_chunk& chunk)
+	{
+		if (m_failed)
+		{
+			return;
+		}
+
+		std::vector<u8> packed(::compressBound(::narrow<uLong>(chunk.data.size(), HERE)));
+		uLongf packed_size = ::narrow<uLongf>(packed.size(), HERE);
+
+		// Favor speed, the game is running meanwhile
+		if (::compress2(packed.data(), &packed_size, chunk.data.data(), ::narrow<uLong>(chunk.data.size(), HERE), Z_BEST_SPEED) != Z_OK)
+		{
+			LOG_ERROR(RSX, "Capture stream: failed to compress chunk (type=%u, size=0x%x)", static_cast<u32>(chunk.header.type), chunk.data.size());
+			m_failed = true;
+			return;
+		}
+
+		chunk.header.raw_size = ::size32(chunk.data);
+		chunk.header.packed_size = ::narrow<u32>(packed_size, HERE);
+
+		if (m_file.write(&chunk.header, sizeof(chunk.header)) != sizeof(chunk.header) || m_file.write(packed.data(), packed_size) != packed_size)
+		{
+			LOG_ERROR(RSX, "Capture stream: failed to write %s", m_path);
+			m_failed = true;
+		}
+	}
+
+	void capture_stream_writer::flush_data()
+	{
+		if (!m_data_chunk_count)
+		{
+			return;
+		}
+
+		submit(capture_stream::chunk_type::data, std::move(m_data_chunk), m_data_chunk_first, m_data_chunk_count);
+
+		m_data_chunk.clear();
+		m_data_chunk_first += m_data_chunk_count;
+		m_data_chunk_count = 0;
+	}
+
+	void capture_stream_writer::add_data(u64 hash, const std::vector<u8>& data)
+	{
+		// Hash collisions can't be checked against contents which are already written
+		if (!m_data_ids.emplace(hash, ::size32(m_data_ids)).second)
+		{
+			return;
+		}
+
+		byte_writer out{m_data_chunk};
+		out.put_varint(data.size());
+		out.put(data.data(), data.size());
+
+		m_data_chunk_count++;
+
+		if (m_data_chunk.size() >= data_chunk_size)
+		{
+			flush_data();
+		}
+	}
+
+	void capture_stream_writer::add_frame(const frame_capture_data& frame)
+	{
+		// Contents used by the frame are written first
+		flush_data();
+
+		std::vector<u8> blocks, tiles, display_buffers, commands;
+		byte_writer blocks_out{blocks}, tiles_out{tiles}, display_buffers_out{display_buffers}, commands_out{commands};
+
+		const u32 first_block = ::size32(m_block_ids);
+		const u32 first_tile = ::size32(m_tile_ids);
+		const u32 first_display_buffer = ::size32(m_display_buffer_ids);
+
+		std::vector<u32> state, last_state, removed, added;
+
+		commands_out.put_varint(frame.replay_commands.size());
+
+		for (const auto& cmd : frame.replay_commands)
+		{
+			const u32 flags = (cmd.memory_state.empty() ? 0 : 1) | (cmd.tile_state ? 2 : 0) | (cmd.display_buffer_state ? 4 : 0);
+
+			commands_out.put_varint(cmd.rsx_command.first);
+			commands_out.put_varint(cmd.rsx_command.second);
+			commands_out.put_varint(flags);
+
+			if (cmd.tile_state)
+			{
+				const auto found = m_tile_ids.emplace(cmd.tile_state, ::size32(m_tile_ids));
+
+				if (found.second)
+				{
+					tiles_out.put(&frame.tile_map.at(cmd.tile_state), sizeof(frame_capture_data::tile_state));
+				}
+
+				commands_out.put_varint(found.first->second);
+			}
+
+			if (cmd.display_buffer_state)
+			{
+				const auto found = m_display_buffer_ids.emplace(cmd.display_buffer_state, ::size32(m_display_buffer_ids));
+
+				if (found.second)
+				{
+					display_buffers_out.put(&frame.display_buffers_map.at(cmd.display_buffer_state), sizeof(frame_capture_data::display_buffers_state));
+				}
+
+				commands_out.put_varint(found.first->second);
+			}
+
+			if (cmd.memory_state.empty())
+			{
+				continue;
+			}
+
+			state.clear();
+
+			for (u64 hash : cmd.memory_state)
+			{
+				const auto found = m_block_ids.emplace(hash, ::size32(m_block_ids));
+
+				if (found.second)
+				{
+					const auto& block = frame.memory_map.at(hash);
+					blocks_out.put_varint(block.offset);
+					blocks_out.put_varint(block.location);
+					blocks_out.put_varint(m_data_ids.at(block.data_state));
+				}
+
+				state.push_back(found.first->second);
+			}
+
+			// Consecutive draws mostly use the same blocks, store the difference to the previous memory state
+			std::sort(state.begin(), state.end());
+
+			removed.clear();
+			added.clear();
+			std::set_difference(last_state.begin(), last_state.end(), state.begin(), state.end(), std::back_inserter(removed));
+			std::set_difference(state.begin(), state.end(), last_state.begin(), last_state.end(), std::back_inserter(added));
+
+			commands_out.put_id_list(removed);
+			commands_out.put_id_list(added);
+
+			last_state.swap(state);
+		}
+
+		std::vector<u8> record;
+		byte_writer out{record};
+
+		out.put_varint(first_block);
+		out.put_varint(::size32(m_block_ids) - first_block);
+		out.put(blocks.data(), blocks.size());
+		out.put_varint(first_tile);
+		out.put_varint(::size32(m_tile_ids) - first_tile);
+		out.put(tiles.data(), tiles.size());
+		out.put_varint(first_display_buffer);
+		out.put_varint(::size32(m_display_buffer_ids) - first_display_buffer);
+		out.put(display_buffers.data(), display_buffers.size());
+		out.put(commands.data(), commands.size());
+
+		submit(capture_stream::chunk_type::frame, std::move(record), frame.get_fifo_size());
+		m_frames++;
+	}
+
+	capture_stream_reader::capture_stream_reader(fs::file&& file)
+		: m_file(std::move(file))
+	{
+		const u64 size = m_file.size();
+		u64 pos = 8;
+
+		while (pos + sizeof(capture_stream::chunk_header) <= size)
+		{
+			capture_stream::chunk_header header;
+			m_file.seek(pos);
+			m_file.read(&header, sizeof(header));
+
+			const u64 next = pos + sizeof(header) + header.packed_size;
+
+			if (next > size)
+			{
+				LOG_WARNING(LOADER, "Capture file is truncated (%u frames complete)", m_frames.size());
+				break;
+			}
+
+			switch (header.type)
+			{
+			case capture_stream::chunk_type::registers:
+				m_registers_pos = pos;
+				break;
+			case capture_stream::chunk_type::data:
+				m_data_chunks.emplace_back(data_chunk{pos, header.arg0, header.arg1});
+				break;
+			case capture_stream::chunk_type::frame:
+				m_frames.emplace_back(pos);
+				m_fifo_size = std::max(m_fifo_size, header.arg0);
+				break;
+			default:
+				LOG_ERROR(LOADER, "Unknown chunk in capture file (type=%u, pos=0x%llx)", static_cast<u32>(header.type), pos);
+				m_frames.clear();
+				return;
+			}
+
+			pos = next;
+		}
+
+		if (m_registers_pos == UINT64_MAX)
+		{
+			LOG_ERROR(LOADER, "Capture file has no register state");
+			m_frames.clear();
+		}
+	}
+
+	std::vector<u8> capture_stream_reader::read_chunk(u64 pos, capture_stream::chunk_header& header) const
+	{
+		std::vector<u8> packed;
+
+		if (m_file.seek(pos) != pos || m_file.read(&header, sizeof(header)) != sizeof(header) || (packed.resize(header.packed_size), m_file.read(packed.data(), packed.size()) != packed.size()))
+		{
+			fmt::throw_exception("Capture stream: failed to read chunk at 0x%llx" HERE, pos);
+		}
+
+		std::vector<u8> data(header.raw_size);
+		uLongf size = header.raw_size;
+
+		if (::uncompress(data.data(), &size, packed.data(), header.packed_size) != Z_OK || size != header.raw_size)
+		{
+			fmt::throw_exception("Capture stream: corrupted chunk at 0x%llx" HERE, pos);
+		}
+
+		return data;
+	}
+
+	std::unique_ptr<frame_capture_data> capture_stream_reader::read_frame(u32 index)
+	{
+		if (index >= m_frames.size() || index > m_decoded)
+		{
+			fmt::throw_exception("Capture stream: frame %u can't be read (%u decoded)" HERE, index, m_decoded);
+		}
+
+		auto frame = std::make_unique<frame_capture_data>();
+		frame->magic = FRAME_CAPTURE_MAGIC;
+		frame->version = FRAME_CAPTURE_STREAM_VERSION;
+
+		capture_stream::chunk_header header;
+		const std::vector<u8> record = read_chunk(m_frames[index], header);
+		byte_reader in{record};
+
+		// New definitions, possibly known already if the frame was decoded before
+		const auto get_range = [&](auto& list)
+		{
+			const u32 first = u32(in.get_varint());
+			const u32 count = u32(in.get_varint());
+
+			if (list.size() < u64{first} + count)
+			{
+				list.resize(u64{first} + count);
+			}
+
+			return std::make_pair(first, first + count);
+		};
+
+		const auto blocks = get_range(m_blocks);
+
+		for (u32 i = blocks.first; i < blocks.second; i++)
+		{
+			m_blocks[i].offset = u32(in.get_varint());
+			m_blocks[i].location = u32(in.get_varint());
+			m_blocks[i].data_state = in.get_varint();
+		}
+
+		const auto tiles = get_range(m_tiles);
+
+		for (u32 i = tiles.first; i < tiles.second; i++)
+		{
+			in.get(m_tiles[i]);
+		}
+
+		const auto display_buffers = get_range(m_display_buffers);
+
+		for (u32 i = display_buffers.first; i < display_buffers.second; i++)
+		{
+			in.get(m_display_buffers[i]);
+		}
+
+		// Keys of the maps in frame_capture_data are ids + 1, 0 means no state
+		const auto check_id = [](u64 id, std::size_t count)
+		{
+			if (id >= count)
+			{
+				fmt::throw_exception("Capture stream: invalid state id %llu" HERE, id);
+			}
+
+			return id + 1;
+		};
+
+		std::vector<u32> state, removed, added, merged;
+
+		frame->replay_commands.resize(in.get_varint());
+
+		for (auto& cmd : frame->replay_commands)
+		{
+			cmd.rsx_command.first = u32(in.get_varint());
+			cmd.rsx_command.second = u32(in.get_varint());
+
+			const u64 flags = in.get_varint();
+
+			if (flags & 2)
+			{
+				const u64 id = in.get_varint();
+				cmd.tile_state = check_id(id, m_tiles.size());
+				frame->tile_map.emplace(cmd.tile_state, m_tiles[id]);
+			}
+
+			if (flags & 4)
+			{
+				const u64 id = in.get_varint();
+				cmd.display_buffer_state = check_id(id, m_display_buffers.size());
+				frame->display_buffers_map.emplace(cmd.display_buffer_state, m_display_buffers[id]);
+			}
+
+			if (!(flags & 1))
+			{
+				continue;
+			}
+
+			in.get_id_list(removed);
+			in.get_id_list(added);
+
+			merged.clear();
+			std::set_difference(state.begin(), state.end(), removed.begin(), removed.end(), std::back_inserter(merged));
+			state.clear();
+			std::merge(merged.begin(), merged.end(), added.begin(), added.end(), std::back_inserter(state));
+
+			cmd.memory_state.reserve(state.size());
+
+			for (u32 id : state)
+			{
+				const u64 key = check_id(id, m_blocks.size());
+				cmd.memory_state.insert(key);
+
+				if (frame->memory_map.count(key))
+				{
+					continue;
+				}
+
+				auto block = m_blocks[id];
+				block.data_state++;
+				frame->memory_map.emplace(key, block);
+				frame->memory_data_map.emplace(block.data_state, frame_capture_data::memory_block_data{});
+			}
+		}
+
+		// Load the contents used by the frame, each data chunk is decompressed once
+		std::vector<u64> data_ids;
+		data_ids.reserve(frame->memory_data_map.size());
+
+		for (const auto& data : frame->memory_data_map)
+		{
+			data_ids.push_back(data.first - 1);
+		}
+
+		std::sort(data_ids.begin(), data_ids.end());
+
+		for (auto it = data_ids.begin(); it != data_ids.end();)
+		{
+			const auto chunk = std::upper_bound(m_data_chunks.begin(), m_data_chunks.end(), *it, [](u64 id, const data_chunk& c)
+			{
+				return id < c.first;
+			});
+
+			if (chunk == m_data_chunks.begin() || *it >= u64{chunk[-1].first} + chunk[-1].count)
+			{
+				fmt::throw_exception("Capture stream: memory contents %llu not found" HERE, *it);
+			}
+
+			const data_chunk& source = chunk[-1];
+			const std::vector<u8> contents = read_chunk(source.pos, header);
+			byte_reader data_in{contents};
+
+			for (u64 id = source.first; it != data_ids.end() && *it < u64{source.first} + source.count; id++)
+			{
+				const u64 size = data_in.get_varint();
+				const u8* ptr = data_in.get(size);
+
+				if (id == *it)
+				{
+					frame->memory_data_map[id + 1].data.assign(ptr, ptr + size);
+					++it;
+				}
+			}
+		}
+
+		if (index == 0)
+		{
+			const std::vector<u8> registers = read_chunk(m_registers_pos, header);
+			std::istringstream is(std::string(registers.begin(), registers.end()));
+			cereal::BinaryInputArchive archive(is);
+			archive(frame->reg_state);
+		}
+
+		m_decoded = std::max(m_decoded, index + 1);
+		return frame;
+	}
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "rsx_replay.h"
+#include "Utilities/Thread.h"
+#include "Utilities/mutex.h"
+#include "Utilities/cond.h"
+
+#include <deque>
+
+namespace rsx
+{
+	// Multi-frame capture: file header (magic, version) followed by compressed chunks
+	constexpr u32 FRAME_CAPTURE_STREAM_VERSION = 0x5;
+
+	namespace capture_stream
+	{
+		enum class chunk_type : u32
+		{
+			registers = 1, // Register state at the beginning of the capture
+			data = 2,      // Memory block contents, numbered from arg0, arg1 entries
+			frame = 3,     // Commands and new state definitions of one frame, arg0 = fifo size
+		};
+
+		struct chunk_header
+		{
+			chunk_type type;
+			u32 raw_size;
+			u32 packed_size;
+			u32 arg0;
+			u32 arg1;
+		};
+	}
+
+	/**
+	 * Writes frame_capture_data frame by frame while the game runs.
+	 * Memory contents, memory blocks, tile and display buffer states are stored once for the whole capture
+	 * and referenced by id, command memory states are stored as differences to the previous command.
+	 * Chunks are compressed and written by a separate thread.
+	 */
+	class capture_stream_writer
+	{
+		struct pending_chunk
+		{
+			capture_stream::chunk_header header;
+			std::vector<u8> data;
+		};
+
+		fs::file m_file;
+		std::string m_path;
+
+		shared_mutex m_mutex;
+		cond_variable m_cond;
+
+		std::deque<pending_chunk> m_queue;
+		u64 m_queued_bytes = 0;
+		bool m_closing = false;
+
+		// Set by the writer thread on error, nothing is written afterwards (later frames may reference lost data)
+		atomic_t<bool> m_failed{false};
+
+		std::unique_ptr<named_thread<std::function<void()>>> m_thread;
+
+		// Ids of everything written so far, by content hash
+		std::unordered_map<u64, u32> m_data_ids;
+		std::unordered_map<u64, u32> m_block_ids;
+		std::unordered_map<u64, u32> m_tile_ids;
+		std::unordered_map<u64, u32> m_display_buffer_ids;
+
+		// Data chunk being filled
+		std::vector<u8> m_data_chunk;
+		u32 m_data_chunk_first = 0;
+		u32 m_data_chunk_count = 0;
+
+		u32 m_frames = 0;
+
+		void submit(capture_stream::chunk_type type, std::vector<u8>&& data, u32 arg0 = 0, u32 arg1 = 0);
+		void flush_data();
+		void write_chunk(pending_chunk& chunk);
+
+	public:
+		capture_stream_writer(fs::file&& file, const std::string& path, const rsx_state& initial_state);
+		~capture_stream_writer();
+
+		// Store memory block contents unless identical contents were stored before
+		void add_data(u64 hash, const std::vector<u8>& data);
+
+		// Store a captured frame (memory_data_map is not used, contents are passed with add_data)
+		void add_frame(const frame_capture_data& frame);
+
+		u32 frame_count() const
+		{
+			return m_frames;
+		}
+
+		// The capture must be aborted, only frames written before the error are usable
+		bool failed() const
+		{
+			return m_failed;
+		}
+
+		const std::string& path() const
+		{
+			return m_path;
+		}
+	};
+
+	// Reads frames of a multi-frame capture in order, loading only the memory contents each frame uses
+	class capture_stream_reader
+	{
+		struct data_chunk
+		{
+			u64 pos;
+			u32 first;
+			u32 count;
+		};
+
+		fs::file m_file;
+
+		u64 m_registers_pos = UINT64_MAX;
+		std::vector<data_chunk> m_data_chunks;
+		std::vector<u64> m_frames;
+		u32 m_fifo_size = 0;
+
+		// Definitions of the frames decoded so far
+		std::vector<frame_capture_data::memory_block> m_blocks;
+		std::vector<frame_capture_data::tile_state> m_tiles;
+		std::vector<frame_capture_data::display_buffers_state> m_display_buffers;
+		u32 m_decoded = 0;
+
+		std::vector<u8> read_chunk(u64 pos, capture_stream::chunk_header& header) const;
+
+	public:
+		// Scans the chunks of the file, frame_count() is 0 on error
+		capture_stream_reader(fs::file&& file);
+
+		u32 frame_count() const
+		{
+			return ::size32(m_frames);
+		}
+
+		// Largest command buffer of all frames
+		u32 fifo_size() const
+		{
+			return m_fifo_size;
+		}
+
+		// Decode a frame, frames can't be skipped on the first pass (frame 0 also gets the register state)
+		std::unique_ptr<frame_capture_data> read_frame(u32 index);
+	};
+}
@@ -1,5 +1,6 @@
 ﻿#include "stdafx.h"
 #include "rsx_replay.h"
+#include "rsx_capture_stream.h"
 
 #include "Emu/System.h"
 #include "Emu/Cell/lv2/sys_rsx.h"
@@ -12,20 +13,24 @@
 
 namespace rsx
 {
-	be_t<u32> rsx_replay_thread::allocate_context()
+	rsx_replay_thread::rsx_replay_thread(std::unique_ptr<frame_capture_data>&& frame_data)
+		: frame(std::move(frame_data))
 	{
-		u32 buffer_size = 4;
+	}
 
-		// run through replay commands to figure out how big command buffer needs to be
-		for (const auto& rc : frame->replay_commands)
-		{
-			const u32 count = (rc.rsx_command.first >> 18) & 0x7ff;
-			// allocate for register plus w/e number of arguments it has
-			buffer_size += (count * 4) + 4;
-		}
+	rsx_replay_thread::rsx_replay_thread(std::unique_ptr<capture_stream_reader>&& frame_stream)
+		: stream(std::move(frame_stream))
+	{
+	}
 
+	rsx_replay_thread::~rsx_replay_thread()
+	{
+	}
+
+	be_t<u32> rsx_replay_thread::allocate_context(u32 fifo_size)
+	{
 		// User memory + fifo size
-		buffer_size = ::align<u32>(buffer_size, 0x100000) + 0x10000000;
+		u32 buffer_size = ::align<u32>(fifo_size, 0x100000) + 0x10000000;
 		// We are not allowed to drain all memory so add a little 
 		fxm::make_always<lv2_memory_container>(buffer_size + 0x1000000);
 
@@ -171,74 +176,93 @@ namespace rsx
 
 	void rsx_replay_thread::on_task()
 	{
-		be_t<u32> context_id = allocate_context();
+		// Whole frames of a stream are loaded in turn, the first frame begins with the register state
+		const u32 frame_count = stream ? stream->frame_count() : 1;
 
-		auto fifo_stops = alloc_write_fifo(context_id);
+		be_t<u32> context_id = allocate_context(stream ? stream->fifo_size() : frame->get_fifo_size());
 
 		while (!Emu.IsStopped())
 		{
-			// Load registers while the RSX is still idle
-			method_registers = frame->reg_state;
-			_mm_mfence();
-
-			// start up fifo buffer by dumping the put ptr to first stop
-			sys_rsx_context_attribute(context_id, 0x001, 0x10000000, fifo_stops[0], 0, 0);
-
-			auto render = get_current_renderer();
-			auto last_flip = render->int_flip_index;
-
-			size_t stopIdx = 0;
-			for (const auto& replay_cmd : frame->replay_commands)
+			for (u32 frame_index = 0; frame_index < frame_count && !Emu.IsStopped(); frame_index++)
 			{
-				while (Emu.IsPaused())
-					std::this_thread::sleep_for(10ms);
-
-				if (Emu.IsStopped())
-					break;
+				if (stream)
+				{
+					frame = stream->read_frame(frame_index);
+				}
 
-				// Loop and hunt down our next state change that needs to be done
-				if (!((replay_cmd.memory_state.size() > 0) || (replay_cmd.display_buffer_state != 0) || (replay_cmd.tile_state != 0)))
-					continue;
+				auto fifo_stops = alloc_write_fifo(context_id);
 
-				// wait until rsx idle and at our first 'stop' to apply state
-				while (!Emu.IsStopped() && (render->ctrl->get != render->ctrl->put) && (render->ctrl->get != fifo_stops[stopIdx]))
+				if (frame_index == 0)
 				{
-					while (Emu.IsPaused())
-						std::this_thread::sleep_for(10ms);
-					std::this_thread::yield();
+					// Load registers while the RSX is still idle
+					method_registers = frame->reg_state;
+					_mm_mfence();
 				}
 
-				stopIdx++;
+				replay_frame(context_id, fifo_stops);
+			}
+		}
+	}
 
-				apply_frame_state(context_id, replay_cmd);
+	void rsx_replay_thread::replay_frame(be_t<u32> context_id, const std::vector<u32>& fifo_stops)
+	{
+		// start up fifo buffer by dumping the put ptr to first stop
+		sys_rsx_context_attribute(context_id, 0x001, 0x10000000, fifo_stops[0], 0, 0);
 
-				// move put ptr to next stop
-				if (stopIdx >= fifo_stops.size())
-					fmt::throw_exception("Capture Replay: StopIdx greater than size of fifo_stops");
+		auto render = get_current_renderer();
+		auto last_flip = render->int_flip_index;
 
-				render->ctrl->put = fifo_stops[stopIdx];
-			}
+		size_t stopIdx = 0;
+		for (const auto& replay_cmd : frame->replay_commands)
+		{
+			while (Emu.IsPaused())
+				std::this_thread::sleep_for(10ms);
+
+			if (Emu.IsStopped())
+				break;
 
-			// dump put to end of stops, which should have actual end
-			u32 end = fifo_stops.back();
-			render->ctrl->put = end;
+			// Loop and hunt down our next state change that needs to be done
+			if (!((replay_cmd.memory_state.size() > 0) || (replay_cmd.display_buffer_state != 0) || (replay_cmd.tile_state != 0)))
+				continue;
 
-			while (render->ctrl->get != end && !Emu.IsStopped())
+			// wait until rsx idle and at our first 'stop' to apply state
+			while (!Emu.IsStopped() && (render->ctrl->get != render->ctrl->put) && (render->ctrl->get != fifo_stops[stopIdx]))
 			{
 				while (Emu.IsPaused())
 					std::this_thread::sleep_for(10ms);
+				std::this_thread::yield();
 			}
 
-			// Check if the captured application used syscall instead of a gcm command to flip
-			if (render->int_flip_index == last_flip)
-			{
-				// Capture did not include a display flip, flip manually
-				render->request_emu_flip(1u);
-			}
+			stopIdx++;
+
+			apply_frame_state(context_id, replay_cmd);
 
-			// random pause to not destroy gpu
-			std::this_thread::sleep_for(10ms);
+			// move put ptr to next stop
+			if (stopIdx >= fifo_stops.size())
+				fmt::throw_exception("Capture Replay: StopIdx greater than size of fifo_stops");
+
+			render->ctrl->put = fifo_stops[stopIdx];
+		}
+
+		// dump put to end of stops, which should have actual end
+		u32 end = fifo_stops.back();
+		render->ctrl->put = end;
+
+		while (render->ctrl->get != end && !Emu.IsStopped())
+		{
+			while (Emu.IsPaused())
+				std::this_thread::sleep_for(10ms);
 		}
+
+		// Check if the captured application used syscall instead of a gcm command to flip
+		if (render->int_flip_index == last_flip)
+		{
+			// Capture did not include a display flip, flip manually
+			render->request_emu_flip(1u);
+		}
+
+		// random pause to not destroy gpu
+		std::this_thread::sleep_for(10ms);
 	}
 
 	void rsx_replay_thread::operator()()
@@ -177,11 +177,30 @@ namespace rsx
 			version = FRAME_CAPTURE_VERSION;
 			tile_map.clear();
 			memory_map.clear();
+			memory_data_map.clear();
+			display_buffers_map.clear();
 			replay_commands.clear();
 			reg_state = method_registers;
 		}
+
+		// Size of the command buffer needed to replay the commands
+		u32 get_fifo_size() const
+		{
+			u32 buffer_size = 4;
+
+			for (const auto& rc : replay_commands)
+			{
+				const u32 count = (rc.rsx_command.first >> 18) & 0x7ff;
+				// allocate for register plus w/e number of arguments it has
+				buffer_size += (count * 4) + 4;
+			}
+
+			return buffer_size;
+		}
 	};
 
+	class capture_stream_reader;
+
 
 	class rsx_replay_thread
 	{
@@ -209,17 +228,20 @@ namespace rsx
 		current_state cs;
 		std::unique_ptr<frame_capture_data> frame;
 
+		// Multi-frame capture, frame holds the frame being replayed
+		std::unique_ptr<capture_stream_reader> stream;
+
 	public:
-		rsx_replay_thread(std::unique_ptr<frame_capture_data>&& frame_data)
-			:frame(std::move(frame_data))
-		{
-		}
+		rsx_replay_thread(std::unique_ptr<frame_capture_data>&& frame_data);
+		rsx_replay_thread(std::unique_ptr<capture_stream_reader>&& frame_stream);
+		~rsx_replay_thread();
 
 		void on_task();
 		void operator()();
 	private:
-		be_t<u32> allocate_context();
+		be_t<u32> allocate_context(u32 fifo_size);
 		std::vector<u32> alloc_write_fifo(be_t<u32> context_id);
+		void replay_frame(be_t<u32> context_id, const std::vector<u32>& fifo_stops);
 		void apply_frame_state(be_t<u32> context_id, const frame_capture_data::replay_command& replay_cmd);
 	};
 }
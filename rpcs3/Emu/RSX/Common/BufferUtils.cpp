@@ -17,6 +17,11 @@ const bool s_use_ssse3 =
 #define _mm_shuffle_epi8
 #endif
 
+#if defined(_MSC_VER) || defined(__SSE4_1__)
+#define INDEX_SSE41_AVAILABLE 1
+const bool s_use_sse41 = utils::has_sse41();
+#endif
+
 namespace
 {
 	// FIXME: GSL as_span break build if template parameter is non const with current revision.
@@ -558,6 +563,179 @@ namespace
 		return value;
 	}
 
+#ifdef INDEX_SSE41_AVAILABLE
+	// SSE4.1 index operations (byteswap is fused with the load)
+	template <typename T>
+	struct index_sse41;
+
+	template <>
+	struct index_sse41<u16>
+	{
+		static constexpr u32 count = 8;
+
+		static __m128i load(const void* src)
+		{
+			const __m128i mask = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+			return _mm_shuffle_epi8(_mm_loadu_si128(static_cast<const __m128i*>(src)), mask);
+		}
+
+		static __m128i set1(u16 value) { return _mm_set1_epi16(value); }
+		static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+		static __m128i min(__m128i a, __m128i b) { return _mm_min_epu16(a, b); }
+		static __m128i max(__m128i a, __m128i b) { return _mm_max_epu16(a, b); }
+
+		static u16 hmin(__m128i v)
+		{
+			return static_cast<u16>(_mm_cvtsi128_si32(_mm_minpos_epu16(v)));
+		}
+
+		static u16 hmax(__m128i v)
+		{
+			const __m128i ones = _mm_set1_epi32(-1);
+			return ~static_cast<u16>(_mm_cvtsi128_si32(_mm_minpos_epu16(_mm_xor_si128(v, ones))));
+		}
+
+		// Two quads (a0 a1 a2 a3 b0 b1 b2 b3) to four triangles (a0 a1 a2 a2 a3 a0 b0 b1 b2 b2 b3 b0)
+		static void expand_quads(__m128i v, void* dst)
+		{
+			const __m128i lo = _mm_shuffle_epi8(v, _mm_set_epi8(11, 10, 9, 8, 1, 0, 7, 6, 5, 4, 5, 4, 3, 2, 1, 0));
+			const __m128i hi = _mm_shuffle_epi8(v, _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 9, 8, 15, 14, 13, 12, 13, 12));
+			_mm_storeu_si128(static_cast<__m128i*>(dst), lo);
+			_mm_storel_epi64(static_cast<__m128i*>(dst) + 1, hi);
+		}
+	};
+
+	template <>
+	struct index_sse41<u32>
+	{
+		static constexpr u32 count = 4;
+
+		static __m128i load(const void* src)
+		{
+			const __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+			return _mm_shuffle_epi8(_mm_loadu_si128(static_cast<const __m128i*>(src)), mask);
+		}
+
+		static __m128i set1(u32 value) { return _mm_set1_epi32(value); }
+		static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+		static __m128i min(__m128i a, __m128i b) { return _mm_min_epu32(a, b); }
+		static __m128i max(__m128i a, __m128i b) { return _mm_max_epu32(a, b); }
+
+		static u32 hmin(__m128i v)
+		{
+			v = min(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+			v = min(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtsi128_si32(v);
+		}
+
+		static u32 hmax(__m128i v)
+		{
+			v = max(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+			v = max(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtsi128_si32(v);
+		}
+
+		// One quad (a0 a1 a2 a3) to two triangles (a0 a1 a2 a2 a3 a0)
+		static void expand_quads(__m128i v, void* dst)
+		{
+			_mm_storeu_si128(static_cast<__m128i*>(dst), _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 2, 1, 0)));
+			_mm_storel_epi64(static_cast<__m128i*>(dst) + 1, _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 0, 0, 3)));
+		}
+	};
+
+	// Byteswap and copy whole vectors, returns the number of indices processed
+	template <typename T>
+	u32 upload_untouched_sse41(const be_t<T>* src, T* dst, u32 size, T& min_index, T& max_index)
+	{
+		using op = index_sse41<T>;
+
+		__m128i min = op::set1(min_index);
+		__m128i max = op::set1(max_index);
+		u32 i = 0;
+
+		for (; i + op::count <= size; i += op::count)
+		{
+			const __m128i v = op::load(src + i);
+			min = op::min(min, v);
+			max = op::max(max, v);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+		}
+
+		min_index = op::hmin(min);
+		max_index = op::hmax(max);
+		return i;
+	}
+
+	// Byteswap and copy whole vectors with primitive restart (restart indices are replaced or skipped)
+	template <typename T>
+	u32 upload_restart_sse41(const be_t<T>* src, T* dst, u32 size, T restart_index, bool skip_restart, T& min_index, T& max_index, u32& dst_index)
+	{
+		using op = index_sse41<T>;
+
+		const __m128i restart = op::set1(restart_index);
+		__m128i min = op::set1(min_index);
+		__m128i max = op::set1(max_index);
+		u32 i = 0;
+
+		for (; i + op::count <= size; i += op::count)
+		{
+			const __m128i v = op::load(src + i);
+			const __m128i mask = op::cmpeq(v, restart);
+
+			if (skip_restart && _mm_movemask_epi8(mask))
+			{
+				// Rare: compact the vector
+				alignas(16) T tmp[op::count];
+				_mm_store_si128(reinterpret_cast<__m128i*>(tmp), v);
+
+				for (const T index : tmp)
+				{
+					if (index != restart_index)
+					{
+						dst[dst_index++] = min_max(min_index, max_index, index);
+					}
+				}
+
+				continue;
+			}
+
+			// Restart indices become index_limit (all ones) and don't affect min/max
+			const __m128i out = _mm_or_si128(v, mask);
+			min = op::min(min, out);
+			max = op::max(max, _mm_andnot_si128(mask, v));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + dst_index), out);
+			dst_index += op::count;
+		}
+
+		min_index = std::min<T>(min_index, op::hmin(min));
+		max_index = std::max<T>(max_index, op::hmax(max));
+		return i;
+	}
+
+	// Expand whole vectors of quads without primitive restart, returns the number of indices processed
+	template <typename T>
+	u32 expand_quads_sse41(const be_t<T>* src, T* dst, u32 size, T& min_index, T& max_index)
+	{
+		using op = index_sse41<T>;
+
+		__m128i min = op::set1(min_index);
+		__m128i max = op::set1(max_index);
+		u32 i = 0;
+
+		for (; i + op::count <= size; i += op::count)
+		{
+			const __m128i v = op::load(src + i);
+			min = op::min(min, v);
+			max = op::max(max, v);
+			op::expand_quads(v, dst + i / 4 * 6);
+		}
+
+		min_index = op::hmin(min);
+		max_index = op::hmax(max);
+		return i;
+	}
+#endif
+
 	struct untouched_impl
 	{
 		template<typename T>
@@ -567,7 +745,15 @@ namespace
 			T min_index = index_limit<T>(), max_index = 0;
 			u32 dst_index = 0;
 
-			for (const T index : src)
+#ifdef INDEX_SSE41_AVAILABLE
+			if (LIKELY(s_use_sse41))
+			{
+				verify(HERE), dst.size() >= src.size();
+				dst_index = upload_untouched_sse41<T>(src.data(), dst.data(), ::narrow<u32>(src.size()), min_index, max_index);
+			}
+#endif
+
+			for (const T index : src.subspan(dst_index))
 			{
 				dst[dst_index++] = min_max(min_index, max_index, index);
 			}
@@ -584,8 +770,23 @@ namespace
 		{
 			T min_index = index_limit<T>(), max_index = 0;
 			u32 dst_index = 0;
+			u32 src_index = 0;
 
-			for (const T index : src)
+			if (restart_index > index_limit<T>())
+			{
+				// Restart index can't be matched
+				return untouched_impl::upload_untouched<T>(src, dst);
+			}
+
+#ifdef INDEX_SSE41_AVAILABLE
+			if (LIKELY(s_use_sse41))
+			{
+				verify(HERE), dst.size() >= src.size();
+				src_index = upload_restart_sse41<T>(src.data(), dst.data(), ::narrow<u32>(src.size()), static_cast<T>(restart_index), skip_restart, min_index, max_index, dst_index);
+			}
+#endif
+
+			for (const T index : src.subspan(src_index))
 			{
 				if (index == restart_index)
 				{
@@ -609,7 +810,7 @@ namespace
 	{
 		if (LIKELY(!is_primitive_restart_enabled))
 		{
-			return untouched_impl::upload_untouched(src, dst);
+			return untouched_impl::upload_untouched<T>(src, dst);
 		}
 		else
 		{
@@ -679,10 +880,19 @@ namespace
 		verify(HERE), (4 * dst.size_bytes() >= 6 * src.size_bytes());
 
 		u32 dst_idx = 0;
+		u32 src_idx = 0;
 		u8 set_size = 0;
 		T tmp_indices[4];
 
-		for (const T index : src)
+#ifdef INDEX_SSE41_AVAILABLE
+		if (LIKELY(s_use_sse41) && (!is_primitive_restart_enabled || primitive_restart_index > index_limit<T>()))
+		{
+			src_idx = expand_quads_sse41<T>(src.data(), dst.data(), ::narrow<u32>(src.size()), min_index, max_index);
+			dst_idx = src_idx / 4 * 6;
+		}
+#endif
+
+		for (const T index : src.subspan(src_idx))
 		{
 			if (is_primitive_restart_enabled && index == primitive_restart_index)
 			{
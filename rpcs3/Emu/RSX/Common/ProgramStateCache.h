@@ -173,6 +173,18 @@ public:
 		}
 	};
 
+	struct async_preload_task_entry
+	{
+		async_decompile_task_entry vp;
+		async_decompile_task_entry fp;
+		pipeline_properties props;
+
+		async_preload_task_entry(const RSXVertexProgram& _V, const RSXFragmentProgram& _F, const pipeline_properties& _P)
+			: vp(_V), fp(_F), props(_P)
+		{
+		}
+	};
+
 protected:
 	shared_mutex m_pipeline_mutex;
 	shared_mutex m_decompiler_mutex;
@@ -187,6 +199,7 @@ protected:
 
 	std::unordered_map <pipeline_key, std::unique_ptr<async_link_task_entry>, pipeline_key_hash, pipeline_key_compare> m_link_queue;
 	std::deque<async_decompile_task_entry> m_decompile_queue;
+	std::deque<async_preload_task_entry> m_preload_queue; // Cached pipelines to build in background, in priority order
 
 	vertex_program_type __null_vertex_program;
 	fragment_program_type __null_fragment_program;
@@ -373,7 +386,7 @@ public:
 			}
 		}
 
-		async_link_task_entry* link_entry;
+		async_link_task_entry* link_entry = nullptr;
 		pipeline_key key;
 		{
 			reader_lock lock(m_pipeline_mutex);
@@ -383,12 +396,21 @@ public:
 				link_entry = It->second.get();
 				key = It->first;
 			}
-			else
+			else if (busy)
 			{
 				return { busy, false };
 			}
 		}
 
+		if (!link_entry)
+		{
+			// Requests from the title are done, continue building cached pipelines
+			const bool linked = preload_one(std::forward<Args>(args)...);
+
+			reader_lock lock(m_decompiler_mutex);
+			return { !m_preload_queue.empty(), linked };
+		}
+
 		pipeline_storage_type pipeline = backend_traits::build_pipeline(link_entry->vp, link_entry->fp, link_entry->props, std::forward<Args>(args)...);
 		LOG_SUCCESS(RSX, "New program compiled successfully");
 
@@ -399,6 +421,87 @@ public:
 		return { (busy || !m_link_queue.empty()), true };
 	}
 
+	// Decompile both programs of the pipeline and get the link task (nullptr if the pipeline already exists)
+	// Decompilation must be done by one thread at a time, link tasks can be built concurrently with link_pipeline()
+	std::unique_ptr<async_link_task_entry> prepare_pipeline(const RSXVertexProgram& vp, const RSXFragmentProgram& fp, pipeline_properties& props)
+	{
+		std::lock_guard lock(m_decompiler_mutex);
+
+		const vertex_program_type& vertex_program = std::get<0>(search_vertex_program(vp));
+		const fragment_program_type& fragment_program = std::get<0>(search_fragment_program(fp));
+
+		backend_traits::validate_pipeline_properties(vertex_program, fragment_program, props);
+
+		reader_lock lock2(m_pipeline_mutex);
+
+		if (m_storage.count({ vertex_program.id, fragment_program.id, props }))
+		{
+			return nullptr;
+		}
+
+		return std::make_unique<async_link_task_entry>(vertex_program, fragment_program, props);
+	}
+
+	template<typename... Args>
+	void link_pipeline(const async_link_task_entry& task, Args&& ...args)
+	{
+		pipeline_storage_type pipeline = backend_traits::build_pipeline(task.vp, task.fp, task.props, std::forward<Args>(args)...);
+
+		std::lock_guard lock(m_pipeline_mutex);
+		m_storage.emplace(pipeline_key{ task.vp.id, task.fp.id, task.props }, std::move(pipeline));
+	}
+
+	// Queue cached pipeline for building in async_update() after the requests from the title
+	void queue_pipeline(const RSXVertexProgram& vp, const RSXFragmentProgram& fp, const pipeline_properties& props)
+	{
+		std::lock_guard lock(m_decompiler_mutex);
+		m_preload_queue.emplace_back(vp, fp, props);
+	}
+
+	// Build the next queued cached pipeline, returns true if a pipeline was linked
+	template<typename... Args>
+	bool preload_one(Args&& ...args)
+	{
+		std::unique_ptr<async_link_task_entry> task;
+
+		{
+			std::lock_guard lock(m_decompiler_mutex);
+
+			if (m_preload_queue.empty())
+			{
+				return false;
+			}
+
+			auto& entry = m_preload_queue.front();
+
+			const vertex_program_type& vertex_program = std::get<0>(search_vertex_program(entry.vp.vp));
+			const fragment_program_type& fragment_program = std::get<0>(search_fragment_program(entry.fp.fp));
+
+			backend_traits::validate_pipeline_properties(vertex_program, fragment_program, entry.props);
+
+			const pipeline_key key = { vertex_program.id, fragment_program.id, entry.props };
+
+			{
+				reader_lock lock2(m_pipeline_mutex);
+
+				if (!m_storage.count(key) && !m_link_queue.count(key))
+				{
+					task = std::make_unique<async_link_task_entry>(vertex_program, fragment_program, entry.props);
+				}
+			}
+
+			m_preload_queue.pop_front();
+		}
+
+		if (!task)
+		{
+			return false;
+		}
+
+		link_pipeline(*task, std::forward<Args>(args)...);
+		return true;
+	}
+
 	template<typename... Args>
 	pipeline_storage_type& get_graphics_pipeline(
 		const RSXVertexProgram& vertexShader,
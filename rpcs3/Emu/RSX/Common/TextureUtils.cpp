@@ -419,6 +419,71 @@ void upload_texture_subresource(gsl::span<gsl::byte> dst_buffer, const rsx_subre
  * A texture is stored as an array of blocks, where a block is a pixel for standard texture
  * but is a structure containing several pixels for compressed format
  */
+namespace rsx
+{
+	void texture_upload_stager::queue(gsl::span<gsl::byte> dst_buffer, const rsx_subresource_layout &src_layout, int format, bool is_swizzled, bool vtc_support, size_t dst_row_pitch_multiple_of)
+	{
+		m_batch.push_back({ dst_buffer, src_layout, format, is_swizzled, vtc_support, dst_row_pitch_multiple_of });
+		m_batch_size += src_layout.data.size_bytes();
+
+		const auto src_begin = src_layout.data.data();
+		const auto src_end = src_begin + src_layout.data.size_bytes();
+
+		if (!m_src_begin || src_begin < m_src_begin)
+		{
+			m_src_begin = src_begin;
+		}
+
+		if (src_end > m_src_end)
+		{
+			m_src_end = src_end;
+		}
+
+		if (m_batch_size >= min_job_size)
+		{
+			flush();
+		}
+	}
+
+	void texture_upload_stager::flush()
+	{
+		if (m_batch.empty())
+		{
+			return;
+		}
+
+		if (!m_pool)
+		{
+			m_pool = get_host_job_pool();
+			m_fence = std::make_shared<host_job_pool::fence>();
+		}
+
+		m_pool->submit(m_fence, [tasks = std::move(m_batch)]()
+		{
+			for (const upload_task& task : tasks)
+			{
+				upload_texture_subresource(task.dst_buffer, task.src_layout, task.format, task.is_swizzled, task.vtc_support, task.dst_row_pitch_multiple_of);
+			}
+		});
+
+		m_batch.clear();
+		m_batch_size = 0;
+	}
+
+	void texture_upload_stager::wait()
+	{
+		flush();
+
+		if (m_fence)
+		{
+			m_pool->wait(*m_fence);
+		}
+
+		m_src_begin = nullptr;
+		m_src_end = nullptr;
+	}
+}
+
 u8 get_format_block_size_in_bytes(int format)
 {
 	switch (format)
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "../RSXTexture.h"
+#include "host_job_pool.h"
 
 #include <vector>
 #include "Utilities/GSL.h"
@@ -96,6 +97,68 @@ std::vector<rsx_subresource_layout> get_subresources_layout(const rsx::vertex_te
 
 void upload_texture_subresource(gsl::span<gsl::byte> dst_buffer, const rsx_subresource_layout &src_layout, int format, bool is_swizzled, bool vtc_support, size_t dst_row_pitch_multiple_of);
 
+namespace rsx
+{
+	/**
+	 * Runs upload_texture_subresource on host worker threads.
+	 * Destination memory must stay mapped until wait() returns, which has to happen before the GPU consumes it.
+	 */
+	class texture_upload_stager
+	{
+		struct upload_task
+		{
+			gsl::span<gsl::byte> dst_buffer;
+			rsx_subresource_layout src_layout;
+			int format;
+			bool is_swizzled;
+			bool vtc_support;
+			size_t dst_row_pitch_multiple_of;
+		};
+
+		// Small subresources are grouped into jobs of at least this amount of source data
+		static constexpr size_t min_job_size = 256 * 1024;
+
+		std::vector<upload_task> m_batch;
+		size_t m_batch_size = 0;
+
+		// Bounds of the source data read by the subresources queued since the last wait()
+		const gsl::byte* m_src_begin = nullptr;
+		const gsl::byte* m_src_end = nullptr;
+
+		std::shared_ptr<host_job_pool> m_pool;
+		std::shared_ptr<host_job_pool::fence> m_fence;
+
+	public:
+		texture_upload_stager() = default;
+		texture_upload_stager(const texture_upload_stager&) = delete;
+
+		~texture_upload_stager()
+		{
+			wait();
+		}
+
+		void queue(gsl::span<gsl::byte> dst_buffer, const rsx_subresource_layout &src_layout, int format, bool is_swizzled, bool vtc_support, size_t dst_row_pitch_multiple_of);
+
+		// Start the queued subresources not yet handed to the workers
+		void flush();
+
+		// Wait for all queued subresources
+		void wait();
+
+		bool pending() const
+		{
+			return !m_batch.empty() || (m_fence && !m_fence->signaled());
+		}
+
+		// Check whether queued subresources may still read from the memory range
+		bool reads_from(const void* ptr, size_t size) const
+		{
+			const auto begin = static_cast<const gsl::byte*>(ptr);
+			return m_src_begin < begin + size && begin < m_src_end && pending();
+		}
+	};
+}
+
 u8 get_format_block_size_in_bytes(int format);
 u8 get_format_block_size_in_texel(int format);
 u8 get_format_block_size_in_bytes(rsx::surface_color_format format);
@@ -0,0 +1,105 @@
+#include "stdafx.h"
+#include "host_job_pool.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+
+#include <thread>
+
+namespace rsx
+{
+	host_job_pool::host_job_pool(u32 count)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			m_workers.emplace_back(fmt::format("RSX Host Worker %u", i), [this]()
+			{
+				while (thread_ctrl::state() != thread_state::aborting)
+				{
+					if (run_one())
+					{
+						continue;
+					}
+
+					std::lock_guard lock(m_mutex);
+
+					if (m_jobs.empty())
+					{
+						m_cond.wait(m_mutex, 10000);
+					}
+				}
+			});
+		}
+	}
+
+	bool host_job_pool::run_one()
+	{
+		job next;
+		{
+			std::lock_guard lock(m_mutex);
+
+			if (m_jobs.empty())
+			{
+				return false;
+			}
+
+			next = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		next.func();
+
+		if (!--next.done->pending)
+		{
+			// Don't notify before a waiter which has seen the fence pending starts waiting
+			{
+				std::lock_guard lock(m_mutex);
+			}
+
+			m_cond.notify_all();
+		}
+
+		return true;
+	}
+
+	void host_job_pool::submit(const std::shared_ptr<fence>& done, std::function<void()> func)
+	{
+		done->pending++;
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_jobs.emplace_back(job{std::move(func), done});
+		}
+
+		m_cond.notify_all();
+	}
+
+	void host_job_pool::wait(const fence& done)
+	{
+		while (!done.signaled())
+		{
+			if (run_one())
+			{
+				continue;
+			}
+
+			std::lock_guard lock(m_mutex);
+
+			if (!done.signaled())
+			{
+				m_cond.wait(m_mutex, 1000);
+			}
+		}
+	}
+
+	std::shared_ptr<host_job_pool> get_host_job_pool()
+	{
+		u32 count = g_cfg.video.host_worker_threads;
+
+		if (!count)
+		{
+			count = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+		}
+
+		return fxm::get_always<host_job_pool>(count);
+	}
+}
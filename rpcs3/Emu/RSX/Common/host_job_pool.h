@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Utilities/types.h"
+#include "Utilities/Atomic.h"
+#include "Utilities/Thread.h"
+#include "Utilities/mutex.h"
+#include "Utilities/cond.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace rsx
+{
+	// Host threads for CPU-side surface processing (swizzling, texture staging, software blits)
+	class host_job_pool
+	{
+	public:
+		// Completion counter of a group of jobs
+		struct fence
+		{
+			atomic_t<u32> pending{0};
+
+			bool signaled() const
+			{
+				return pending == 0;
+			}
+		};
+
+	private:
+		struct job
+		{
+			std::function<void()> func;
+			std::shared_ptr<fence> done;
+		};
+
+		// Protects m_jobs, used with m_cond
+		shared_mutex m_mutex;
+
+		// Signaled on new jobs and on fence completion
+		cond_variable m_cond;
+
+		std::deque<job> m_jobs;
+
+		std::deque<named_thread<std::function<void()>>> m_workers;
+
+		// Take a job from the queue and run it
+		bool run_one();
+
+	public:
+		host_job_pool(u32 count);
+
+		// Number of worker threads
+		u32 size() const
+		{
+			return ::size32(m_workers);
+		}
+
+		// Queue a job, the fence is signaled when all of its jobs are done
+		void submit(const std::shared_ptr<fence>& done, std::function<void()> func);
+
+		// Wait for the fence, running queued jobs meanwhile
+		void wait(const fence& done);
+
+		// Run func(begin, end) over [0, count) in parts of at least min_part, the calling thread takes the first part
+		template <typename F>
+		void parallel_for(u32 count, u32 min_part, F&& func)
+		{
+			const u32 parts = std::min<u32>(size() + 1, count / std::max<u32>(min_part, 1));
+
+			if (parts <= 1)
+			{
+				func(0u, count);
+				return;
+			}
+
+			const auto done = std::make_shared<fence>();
+
+			for (u32 i = 1; i < parts; i++)
+			{
+				submit(done, [&func, begin = u32(u64{count} * i / parts), end = u32(u64{count} * (i + 1) / parts)]()
+				{
+					func(begin, end);
+				});
+			}
+
+			func(0u, u32(count / parts));
+			wait(*done);
+		}
+	};
+
+	// Get the shared pool (created on first use)
+	std::shared_ptr<host_job_pool> get_host_job_pool();
+}
@@ -0,0 +1,409 @@
+#include "stdafx.h"
+#include "software_blit.h"
+#include "host_job_pool.h"
+
+#include <emmintrin.h>
+
+namespace rsx
+{
+	namespace
+	{
+		// Minimal amount of output data per thread
+		constexpr u32 blit_min_part_size = 256 * 1024;
+
+		// Per thread row buffers
+		thread_local blit_arena g_tls_blit_rows;
+
+		// Per blit sampling tables (read by the workers of the calling thread)
+		thread_local blit_arena g_tls_blit_tables;
+
+		// Horizontal bilinear sample: logical source columns and weight of x1 (in 1/256)
+		struct linear_tap
+		{
+			u32 x0;
+			u32 x1;
+			u32 weight;
+		};
+
+		// Source position of a destination texel center in 16.16 fixed point, texel centers aligned
+		s64 map_coord(u32 dst, u32 src_size, u32 dst_size)
+		{
+			return ((s64{2 * dst + 1} * src_size) << 15) / dst_size - 0x8000;
+		}
+
+		// Nearest source texel of a destination texel
+		u32 map_nearest(u32 dst, u32 src_size, u32 dst_size, u32 limit)
+		{
+			return std::min<u32>(u32((u64{2 * dst + 1} * src_size) / (u64{2} * dst_size)), limit - 1);
+		}
+
+		linear_tap map_linear(u32 dst, u32 src_size, u32 dst_size, u32 limit)
+		{
+			const s64 pos = map_coord(dst, src_size, dst_size);
+
+			if (pos <= 0)
+			{
+				return {0, 0, 0};
+			}
+
+			const u32 x0 = u32(pos >> 16);
+
+			if (x0 + 1 >= limit)
+			{
+				return {limit - 1, limit - 1, 0};
+			}
+
+			return {x0, x0 + 1, u32(pos >> 8) & 0xff};
+		}
+
+		// Texels are stored big-endian: a8r8g8b8 as bytes A R G B
+		u16 bswap16(u16 value)
+		{
+			return u16(value << 8 | value >> 8);
+		}
+
+		u32 rgb565_to_argb8(u16 texel)
+		{
+			const u32 v = bswap16(texel);
+			const u32 r = v >> 11, g = (v >> 5) & 0x3f, b = v & 0x1f;
+			const u32 argb = 0xff000000 | ((r << 19 | r << 14) & 0xff0000) | ((g << 10 | g << 4) & 0xff00) | (b << 3 | b >> 2);
+			return se_storage<u32>::swap(argb);
+		}
+
+		u16 argb8_to_rgb565(u32 texel)
+		{
+			const u32 v = se_storage<u32>::swap(texel);
+			return bswap16(u16(((v >> 8) & 0xf800) | ((v >> 5) & 0x7e0) | ((v >> 3) & 0x1f)));
+		}
+
+		void convert_rgb565_to_argb8(u32* dst, const u16* src, u32 count)
+		{
+			const __m128i mask6 = _mm_set1_epi16(0x3f);
+			const __m128i mask5 = _mm_set1_epi16(0x1f);
+			const __m128i alpha = _mm_set1_epi16(0xff);
+
+			u32 i = 0;
+
+			for (; i + 8 <= count; i += 8)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+
+				// Expand by replicating the high bits
+				const __m128i r5 = _mm_srli_epi16(v, 11);
+				const __m128i g6 = _mm_and_si128(_mm_srli_epi16(v, 5), mask6);
+				const __m128i b5 = _mm_and_si128(v, mask5);
+				const __m128i r = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+				const __m128i g = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+				const __m128i b = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+
+				// Byte pairs (A, R) and (G, B)
+				const __m128i ar = _mm_or_si128(alpha, _mm_slli_epi16(r, 8));
+				const __m128i gb = _mm_or_si128(g, _mm_slli_epi16(b, 8));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(ar, gb));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(ar, gb));
+			}
+
+			for (; i < count; i++)
+			{
+				dst[i] = rgb565_to_argb8(src[i]);
+			}
+		}
+
+		void convert_argb8_to_rgb565(u16* dst, const u32* src, u32 count)
+		{
+			const auto convert4 = [](__m128i p)
+			{
+				// p holds bytes A R G B, so R is bits 8..15, G 16..23 and B 24..31
+				const __m128i r = _mm_and_si128(_mm_srli_epi32(p, 11), _mm_set1_epi32(0x1f));
+				const __m128i g = _mm_and_si128(_mm_srli_epi32(p, 18), _mm_set1_epi32(0x3f));
+				const __m128i b = _mm_srli_epi32(p, 27);
+				const __m128i v = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 11), _mm_slli_epi32(g, 5)), b);
+				const __m128i be = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xff)), 8), _mm_srli_epi32(v, 8));
+
+				// Sign extend so that the signed saturating pack keeps all 16 bits
+				return _mm_srai_epi32(_mm_slli_epi32(be, 16), 16);
+			};
+
+			u32 i = 0;
+
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m128i lo = convert4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+				const __m128i hi = convert4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+			}
+
+			for (; i < count; i++)
+			{
+				dst[i] = argb8_to_rgb565(src[i]);
+			}
+		}
+
+		// Read a logical source row (flip applied) as a8r8g8b8
+		void load_row_argb8(u32* dst, const software_blit_src& src, u32 y)
+		{
+			const u8* row = src.pixels + s64{src.pitch} * y;
+
+			if (src.format == blit_engine::transfer_source_format::a8r8g8b8)
+			{
+				if (!src.flip_x)
+				{
+					std::memcpy(dst, row, src.width * 4u);
+					return;
+				}
+
+				const u32* texels = reinterpret_cast<const u32*>(row);
+
+				for (u32 x = 0; x < src.width; x++)
+				{
+					dst[x] = texels[-s64{x}];
+				}
+
+				return;
+			}
+
+			const u16* texels = reinterpret_cast<const u16*>(row);
+
+			if (!src.flip_x)
+			{
+				convert_rgb565_to_argb8(dst, texels, src.width);
+				return;
+			}
+
+			for (u32 x = 0; x < src.width; x++)
+			{
+				dst[x] = rgb565_to_argb8(texels[-s64{x}]);
+			}
+		}
+
+		// dst = r0 + (r1 - r0) * weight / 256, per channel
+		void blend_rows(u32* dst, const u32* r0, const u32* r1, u32 count, u32 weight)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i w0 = _mm_set1_epi16(s16(256 - weight));
+			const __m128i w1 = _mm_set1_epi16(s16(weight));
+
+			const auto lerp = [&](__m128i a, __m128i b)
+			{
+				return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, w0), _mm_mullo_epi16(b, w1)), 8);
+			};
+
+			u32 i = 0;
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + i));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + i));
+				const __m128i lo = lerp(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+				const __m128i hi = lerp(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+			}
+
+			for (; i < count; i++)
+			{
+				const __m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128(r0[i]), zero);
+				const __m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(r1[i]), zero);
+				dst[i] = _mm_cvtsi128_si32(_mm_packus_epi16(lerp(a, b), zero));
+			}
+		}
+
+		// Horizontal pass of the bilinear filter
+		void filter_row(u32* dst, const u32* row, const linear_tap* taps, u32 count)
+		{
+			const __m128i zero = _mm_setzero_si128();
+
+			for (u32 i = 0; i < count; i++)
+			{
+				const linear_tap& tap = taps[i];
+
+				if (!tap.weight)
+				{
+					dst[i] = row[tap.x0];
+					continue;
+				}
+
+				const __m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128(row[tap.x0]), zero);
+				const __m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(row[tap.x1]), zero);
+				const __m128i w0 = _mm_set1_epi16(s16(256 - tap.weight));
+				const __m128i w1 = _mm_set1_epi16(s16(tap.weight));
+				const __m128i r = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, w0), _mm_mullo_epi16(b, w1)), 8);
+				dst[i] = _mm_cvtsi128_si32(_mm_packus_epi16(r, zero));
+			}
+		}
+
+		template <typename T>
+		void gather_row(T* dst, const u8* row, const s32* offsets, u32 count)
+		{
+			for (u32 i = 0; i < count; i++)
+			{
+				std::memcpy(dst + i, row + offsets[i], sizeof(T));
+			}
+		}
+
+		struct blit_region
+		{
+			u32 x, y, width, height;
+		};
+
+		void blit_nearest(const software_blit_src& src, const software_blit_dst& dst, const blit_region& region, const s32* offsets, u32 begin, u32 end)
+		{
+			const bool src_argb = src.format == blit_engine::transfer_source_format::a8r8g8b8;
+			const bool dst_argb = dst.format == blit_engine::transfer_destination_format::a8r8g8b8;
+
+			// Gathered row in the source format, when it needs converting
+			u8* tmp = src_argb == dst_argb ? nullptr : g_tls_blit_rows.get(region.width * 4u);
+
+			for (u32 y = begin; y < end; y++)
+			{
+				const u32 sy = map_nearest(region.y + y, src.height, dst.scaled_height, src.slice_h);
+				const u8* row = src.pixels + s64{src.pitch} * sy;
+				u8* out = dst.pixels + u64{dst.pitch} * y;
+
+				if (!tmp)
+				{
+					if (dst_argb)
+						gather_row(reinterpret_cast<u32*>(out), row, offsets, region.width);
+					else
+						gather_row(reinterpret_cast<u16*>(out), row, offsets, region.width);
+				}
+				else if (dst_argb)
+				{
+					gather_row(reinterpret_cast<u16*>(tmp), row, offsets, region.width);
+					convert_rgb565_to_argb8(reinterpret_cast<u32*>(out), reinterpret_cast<const u16*>(tmp), region.width);
+				}
+				else
+				{
+					gather_row(reinterpret_cast<u32*>(tmp), row, offsets, region.width);
+					convert_argb8_to_rgb565(reinterpret_cast<u16*>(out), reinterpret_cast<const u32*>(tmp), region.width);
+				}
+			}
+		}
+
+		void blit_linear(const software_blit_src& src, const software_blit_dst& dst, const blit_region& region, const linear_tap* taps, u32 begin, u32 end)
+		{
+			const bool dst_argb = dst.format == blit_engine::transfer_destination_format::a8r8g8b8;
+
+			// Two source rows, the blended row and the converted output row
+			u32* rows = reinterpret_cast<u32*>(g_tls_blit_rows.get((src.width * 3u + region.width) * 4u));
+			u32* row0 = rows;
+			u32* row1 = rows + src.width;
+			u32* blended = rows + src.width * 2;
+			u32* filtered = rows + src.width * 3;
+
+			// Source rows currently loaded in row0 and row1
+			u32 loaded0 = UINT32_MAX, loaded1 = UINT32_MAX;
+
+			for (u32 y = begin; y < end; y++)
+			{
+				const linear_tap tap = map_linear(region.y + y, src.height, dst.scaled_height, src.slice_h);
+
+				if (loaded0 != tap.x0)
+				{
+					if (loaded1 == tap.x0)
+					{
+						std::swap(row0, row1);
+						std::swap(loaded0, loaded1);
+					}
+					else
+					{
+						load_row_argb8(row0, src, tap.x0);
+						loaded0 = tap.x0;
+					}
+				}
+
+				const u32* source = row0;
+
+				if (tap.weight)
+				{
+					if (loaded1 != tap.x1)
+					{
+						load_row_argb8(row1, src, tap.x1);
+						loaded1 = tap.x1;
+					}
+
+					blend_rows(blended, row0, row1, src.width, tap.weight);
+					source = blended;
+				}
+
+				u8* out = dst.pixels + u64{dst.pitch} * y;
+
+				if (dst_argb)
+				{
+					filter_row(reinterpret_cast<u32*>(out), source, taps, region.width);
+				}
+				else
+				{
+					filter_row(filtered, source, taps, region.width);
+					convert_argb8_to_rgb565(reinterpret_cast<u16*>(out), filtered, region.width);
+				}
+			}
+		}
+	}
+
+	void software_blit(const software_blit_src& src, const software_blit_dst& dst, bool interpolate)
+	{
+		if (!src.width || !src.slice_h || !dst.scaled_width || !dst.scaled_height)
+		{
+			return;
+		}
+
+		// Clip region limited to the scaled image
+		blit_region region;
+		region.x = dst.clip_x;
+		region.y = dst.clip_y;
+		region.width = std::min<u32>(dst.clip_x + dst.clip_width, dst.scaled_width) - std::min<u32>(dst.clip_x, dst.scaled_width);
+		region.height = std::min<u32>(dst.clip_y + dst.clip_height, dst.scaled_height) - std::min<u32>(dst.clip_y, dst.scaled_height);
+
+		if (!region.width || !region.height)
+		{
+			return;
+		}
+
+		const u32 out_bpp = dst.format == blit_engine::transfer_destination_format::a8r8g8b8 ? 4 : 2;
+		const u32 min_rows = std::max<u32>(blit_min_part_size / (region.width * out_bpp), 1);
+
+		const auto run = [&](auto&& func)
+		{
+			if (region.height < min_rows * 2)
+			{
+				func(0u, region.height);
+				return;
+			}
+
+			get_host_job_pool()->parallel_for(region.height, min_rows, func);
+		};
+
+		if (!interpolate || (src.width == dst.scaled_width && src.height == dst.scaled_height))
+		{
+			// Byte offset of the source texel of each column, flip included
+			const s32 in_bpp = src.format == blit_engine::transfer_source_format::a8r8g8b8 ? 4 : 2;
+			s32* offsets = reinterpret_cast<s32*>(g_tls_blit_tables.get(region.width * sizeof(s32)));
+
+			for (u32 x = 0; x < region.width; x++)
+			{
+				const s32 sx = map_nearest(region.x + x, src.width, dst.scaled_width, src.width);
+				offsets[x] = (src.flip_x ? -sx : sx) * in_bpp;
+			}
+
+			run([&](u32 begin, u32 end)
+			{
+				blit_nearest(src, dst, region, offsets, begin, end);
+			});
+		}
+		else
+		{
+			linear_tap* taps = reinterpret_cast<linear_tap*>(g_tls_blit_tables.get(region.width * sizeof(linear_tap)));
+
+			for (u32 x = 0; x < region.width; x++)
+			{
+				taps[x] = map_linear(region.x + x, src.width, dst.scaled_width, src.width);
+			}
+
+			run([&](u32 begin, u32 end)
+			{
+				blit_linear(src, dst, region, taps, begin, end);
+			});
+		}
+	}
+}
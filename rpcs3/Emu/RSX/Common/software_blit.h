@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Utilities/types.h"
+#include "../gcm_enums.h"
+
+#include <memory>
+
+namespace rsx
+{
+	// Growable scratch memory, reused between blits to avoid allocations
+	class blit_arena
+	{
+		std::unique_ptr<u8[]> m_data;
+		std::size_t m_size = 0;
+
+	public:
+		u8* get(std::size_t size)
+		{
+			if (size > m_size)
+			{
+				m_data.reset(new u8[size]);
+				m_size = size;
+			}
+
+			return m_data.get();
+		}
+	};
+
+	struct software_blit_src
+	{
+		const u8* pixels; // First texel (the last one in memory along a flipped axis)
+		blit_engine::transfer_source_format format; // r5g6b5 or a8r8g8b8
+		u16 width;
+		u16 height;
+		u16 slice_h; // Number of rows which can be read
+		s32 pitch; // Negative if flipped vertically
+		bool flip_x;
+	};
+
+	struct software_blit_dst
+	{
+		u8* pixels; // Receives the clip region
+		blit_engine::transfer_destination_format format;
+		u32 pitch;
+		u32 scaled_width; // Size of the whole scaled image
+		u32 scaled_height;
+		u16 clip_x; // Region of the scaled image written to pixels
+		u16 clip_y;
+		u16 clip_width;
+		u16 clip_height;
+	};
+
+	/**
+	 * NV3089 software path: scales, converts and clips in one pass.
+	 * Nearest or bilinear filtering, large blits are split in rows across host worker threads.
+	 * Destination must not overlap the source.
+	 */
+	void software_blit(const software_blit_src& src, const software_blit_dst& dst, bool interpolate);
+}
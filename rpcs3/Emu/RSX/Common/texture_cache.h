@@ -331,6 +331,9 @@ namespace rsx
 		std::unordered_map<address_range, section_storage_type*> m_flush_always_cache;
 		u64 m_flush_always_update_timestamp = 0;
 
+		//CPU side texture data staged on host worker threads (backends wait for it before submitting the uploads)
+		texture_upload_stager m_upload_stager;
+
 		//Memory usage
 		const u32 m_max_zombie_objects = 64; //Limit on how many texture objects to keep around for reuse after they are invalidated
 
@@ -1083,10 +1086,26 @@ namespace rsx
 
 		void clear()
 		{
+			m_upload_stager.wait();
 			m_storage.clear();
 			m_predictor.clear();
 		}
 
+		// Wait for texture data being staged on host worker threads, must be done before the upload commands are submitted
+		void sync_staged_uploads()
+		{
+			m_upload_stager.wait();
+		}
+
+		// Staged uploads read guest memory lazily, wait for them before the memory range is modified
+		void sync_staged_uploads(u32 memory_address, u32 memory_range)
+		{
+			if (m_upload_stager.reads_from(vm::base(memory_address), memory_range))
+			{
+				m_upload_stager.wait();
+			}
+		}
+
 		virtual void on_frame_end()
 		{
 			m_temporary_subresource_cache.clear();
@@ -104,18 +104,19 @@ public:
 		return program_hash_util::fragment_program_utils::get_fragment_program_ucode_hash(prog);
 	}
 
-	template <typename... Args>
-	void add_pipeline_entry(RSXVertexProgram &vp, RSXFragmentProgram &fp, void* &props, Args&& ...args)
+	// Decompile cached programs and get the pipeline link task (nullptr if the pipeline already exists)
+	auto prepare_pipeline_entry(RSXVertexProgram &vp, RSXFragmentProgram &fp, void* &props)
 	{
 		vp.skip_vertex_input_check = true;
-		get_graphics_pipeline(vp, fp, props, false, std::forward<Args>(args)...);
+		return prepare_pipeline(vp, fp, props);
 	}
 
-    void preload_programs(RSXVertexProgram &vp, RSXFragmentProgram &fp)
-    {
-		search_vertex_program(vp);
-		search_fragment_program(fp);
-    }
+	// Build cached pipeline later in async_update()
+	void queue_pipeline_entry(RSXVertexProgram &vp, RSXFragmentProgram &fp, void* &props)
+	{
+		vp.skip_vertex_input_check = true;
+		queue_pipeline(vp, fp, props);
+	}
 
 	bool check_cache_missed() const
 	{
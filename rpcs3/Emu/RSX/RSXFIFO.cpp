@@ -527,7 +527,7 @@ namespace rsx
 					replay_cmd.rsx_command = std::make_pair((reg << 2) | (1u << 18), value);
 
 					frame_capture.replay_commands.push_back(replay_cmd);
-					auto it = frame_capture.replay_commands.back();
+					auto& it = frame_capture.replay_commands.back();
 
 					switch (reg)
 					{
@@ -18,8 +18,6 @@
 #include "Utilities/GSL.h"
 #include "Utilities/StrUtil.h"
 
-#include <cereal/archives/binary.hpp>
-
 #include <sstream>
 #include <thread>
 #include <unordered_set>
@@ -34,6 +32,7 @@ bool user_asked_for_frame_capture = false;
 bool capture_current_frame = false;
 rsx::frame_trace_data frame_debug;
 rsx::frame_capture_data frame_capture;
+std::unique_ptr<rsx::capture_stream_writer> frame_capture_writer;
 RSXIOTable RSXIOMem;
 
 extern CellGcmOffsetTable offsetTable;
@@ -564,6 +563,24 @@ namespace rsx
 	void thread::on_exit()
 	{
 		m_rsx_thread_exiting = true;
+
+		// Finish writing an interrupted capture, the frames stored so far stay usable
+		capture_current_frame = false;
+		frame_capture_writer.reset();
+	}
+
+	void thread::begin_frame_capture()
+	{
+		frame_debug.reset();
+
+		// random number just to jumpstart the size
+		frame_capture.replay_commands.reserve(8000);
+
+		// capture first tile state with nop cmd
+		rsx::frame_capture_data::replay_command replay_cmd;
+		replay_cmd.rsx_command = std::make_pair(NV4097_NO_OPERATION, 0);
+		frame_capture.replay_commands.push_back(replay_cmd);
+		capture::capture_display_tile_state(this, frame_capture.replay_commands.back());
 	}
 
 	void thread::fill_scale_offset_data(void *buffer, bool flip_y) const
@@ -2379,37 +2396,54 @@ namespace rsx
 	{
 		if (user_asked_for_frame_capture && !capture_current_frame)
 		{
-			capture_current_frame = true;
 			user_asked_for_frame_capture = false;
-			frame_debug.reset();
 			frame_capture.reset();
 
-			// random number just to jumpstart the size
-			frame_capture.replay_commands.reserve(8000);
+			const std::string dir = fs::get_config_dir() + "captures/";
+			const std::string filePath = dir + Emu.GetTitleID() + "_" + date_time::current_time_narrow() + "_capture.rrc";
 
-			// capture first tile state with nop cmd
-			rsx::frame_capture_data::replay_command replay_cmd;
-			replay_cmd.rsx_command = std::make_pair(NV4097_NO_OPERATION, 0);
-			frame_capture.replay_commands.push_back(replay_cmd);
-			capture::capture_display_tile_state(this, frame_capture.replay_commands.back());
+			fs::file file;
+
+			if (!fs::create_path(dir) || !file.open(filePath, fs::rewrite))
+			{
+				LOG_ERROR(RSX, "capture failed: can't create %s", filePath);
+			}
+			else
+			{
+				capture_current_frame = true;
+				frame_capture_writer = std::make_unique<rsx::capture_stream_writer>(std::move(file), filePath, frame_capture.reg_state);
+				begin_frame_capture();
+			}
 		}
 		else if (capture_current_frame)
 		{
-			capture_current_frame = false;
-			std::stringstream os;
-			cereal::BinaryOutputArchive archive(os);
-			const std::string& filePath = fs::get_config_dir() + "captures/" + Emu.GetTitleID() + "_" + date_time::current_time_narrow() + "_capture.rrc";
-			archive(frame_capture);
+			frame_capture_writer->add_frame(frame_capture);
+			frame_capture.reset();
+
+			if (frame_capture_writer->failed())
+			{
+				capture_current_frame = false;
+
+				const std::string filePath = frame_capture_writer->path();
+				frame_capture_writer.reset();
+
+				LOG_ERROR(RSX, "capture aborted, only frames written before the error are usable: %s", filePath);
+			}
+			else if (frame_capture_writer->frame_count() < g_cfg.video.capture_frame_count)
 			{
-				// todo: may want to compress this data?
-				fs::file f(filePath, fs::rewrite);
-				f.write(os.str());
+				begin_frame_capture();
 			}
+			else
+			{
+				capture_current_frame = false;
 
-			LOG_SUCCESS(RSX, "capture successful: %s", filePath.c_str());
+				const std::string filePath = frame_capture_writer->path();
+				frame_capture_writer.reset();
 
-			frame_capture.reset();
-			Emu.Pause();
+				LOG_SUCCESS(RSX, "capture successful: %s", filePath.c_str());
+
+				Emu.Pause();
+			}
 		}
 
 		double limit = 0.;
@@ -20,6 +20,7 @@
 #include "Utilities/geometry.h"
 #include "Capture/rsx_trace.h"
 #include "Capture/rsx_replay.h"
+#include "Capture/rsx_capture_stream.h"
 
 #include "Emu/Cell/lv2/sys_rsx.h"
 
@@ -53,6 +54,7 @@ extern bool user_asked_for_frame_capture;
 extern bool capture_current_frame;
 extern rsx::frame_trace_data frame_debug;
 extern rsx::frame_capture_data frame_capture;
+extern std::unique_ptr<rsx::capture_stream_writer> frame_capture_writer;
 extern RSXIOTable RSXIOMem;
 
 namespace rsx
@@ -509,6 +511,7 @@ namespace rsx
 		GcmZcullInfo zculls[limits::zculls_count];
 
 		void capture_frame(const std::string &name);
+		void begin_frame_capture();
 
 	public:
 		std::shared_ptr<named_thread<class ppu_thread>> intr_thread;
@@ -640,6 +643,9 @@ namespace rsx
 		void read_barrier(u32 memory_address, u32 memory_range);
 		virtual void sync_hint(FIFO_hint /*hint*/) {}
 
+		// Called before the RSX thread writes guest memory on the CPU (whole address space for releases to other threads)
+		virtual void write_barrier(u32 /*memory_address*/, u32 /*memory_range*/) {}
+
 		gsl::span<const gsl::byte> get_raw_index_array(const draw_clause& draw_indexed_clause) const;
 		gsl::span<const gsl::byte> get_raw_vertex_buffer(const rsx::data_array_format_info&, u32 base_offset, const draw_clause& draw_array_clause) const;
 
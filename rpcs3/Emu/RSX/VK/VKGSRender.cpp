@@ -2198,6 +2198,12 @@ void VKGSRender::sync_hint(rsx::FIFO_hint hint)
 	}
 }
 
+void VKGSRender::write_barrier(u32 memory_address, u32 memory_range)
+{
+	// Texture data staged on host threads must be read before the RSX thread modifies it
+	m_texture_cache.sync_staged_uploads(memory_address, memory_range);
+}
+
 void VKGSRender::advance_queued_frames()
 {
 	//Check all other frames for completion and clear resources
@@ -2778,6 +2784,9 @@ void VKGSRender::write_buffers()
 
 void VKGSRender::close_and_submit_command_buffer(const std::vector<VkSemaphore> &semaphores, VkFence fence, VkPipelineStageFlags pipeline_stage_flags)
 {
+	// Texture data staged on host threads must be in the upload heap before the copies execute
+	m_texture_cache.sync_staged_uploads();
+
 	if (m_attrib_ring_info.dirty() ||
 		m_fragment_env_ring_info.dirty() ||
 		m_vertex_env_ring_info.dirty() ||
@@ -436,6 +436,7 @@ public:
 	void check_window_status();
 
 	void sync_hint(rsx::FIFO_hint hint) override;
+	void write_barrier(u32 memory_address, u32 memory_range) override;
 
 	void begin_occlusion_query(rsx::reports::occlusion_query_info* query) override;
 	void end_occlusion_query(rsx::reports::occlusion_query_info* query) override;
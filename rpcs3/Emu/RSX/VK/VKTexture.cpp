@@ -432,7 +432,7 @@ namespace vk
 
 	void copy_mipmaped_image_using_buffer(VkCommandBuffer cmd, vk::image* dst_image,
 		const std::vector<rsx_subresource_layout>& subresource_layout, int format, bool is_swizzled, u16 mipmap_count,
-		VkImageAspectFlags flags, vk::data_heap &upload_heap)
+		VkImageAspectFlags flags, vk::data_heap &upload_heap, rsx::texture_upload_stager* stager)
 	{
 		u32 mipmap_level = 0;
 		u32 block_in_pixel = get_format_block_size_in_texel(format);
@@ -463,7 +463,16 @@ namespace vk
 			}
 
 			gsl::span<gsl::byte> mapped{ (gsl::byte*)dst, ::narrow<int>(image_linear_size) };
-			upload_texture_subresource(mapped, layout, format, is_swizzled, false, 256);
+
+			if (stager)
+			{
+				stager->queue(mapped, layout, format, is_swizzled, false, 256);
+			}
+			else
+			{
+				upload_texture_subresource(mapped, layout, format, is_swizzled, false, 256);
+			}
+
 			upload_heap.unmap();
 
 			if (dst_image->info.format == VK_FORMAT_D32_SFLOAT_S8_UINT)
@@ -1021,8 +1021,16 @@ namespace vk
 				input_swizzled = false;
 			}
 
+			// The heap is only unmapped with the legacy allocator, the data can be staged asynchronously otherwise
+			const auto stager = g_cfg.video.disable_vulkan_mem_allocator ? nullptr : &m_upload_stager;
+
 			vk::copy_mipmaped_image_using_buffer(cmd, image, subresource_layout, gcm_format, input_swizzled, mipmaps, subres_range.aspectMask,
-				*m_texture_upload_heap);
+				*m_texture_upload_heap, stager);
+
+			if (stager)
+			{
+				stager->flush();
+			}
 
 			vk::leave_uninterruptible();
 
@@ -1094,6 +1102,8 @@ namespace vk
 
 		void cleanup_after_dma_transfers(vk::command_buffer& cmd) override
 		{
+			sync_staged_uploads();
+
 			// End recording
 			cmd.end();
 
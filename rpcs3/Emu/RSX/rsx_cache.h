@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "Utilities/VirtualMemory.h"
 #include "Utilities/hash.h"
+#include "Utilities/Thread.h"
 #include "Emu/Memory/vm.h"
 #include "gcm_enums.h"
 #include "Common/ProgramStateCache.h"
@@ -10,6 +11,7 @@
 
 #include "rsx_utils.h"
 #include <thread>
+#include <deque>
 
 namespace rsx
 {
@@ -411,6 +413,37 @@ namespace rsx
 			pipeline_storage_type pipeline_properties;
 		};
 
+		// Pipeline archive magic ("RSXPIPES")
+		static constexpr u64 archive_magic = 0x5345504950585352;
+
+		// Pipeline archive format version
+		static constexpr u32 archive_version = 1;
+
+		enum record_type : u32
+		{
+			record_fp = 1, // Fragment program ucode
+			record_vp = 2, // Vertex program ucode
+			record_pipeline = 3, // pipeline_data
+			record_use = 4, // Empty, pipeline was requested before being built from the archive
+
+			record_type_count
+		};
+
+		struct archive_header
+		{
+			u64 magic;
+			u32 version;
+			u32 reserved;
+		};
+
+		// Record header (followed by the record data)
+		struct record_header
+		{
+			u32 type;
+			u32 size; // Data size in bytes
+			u64 key; // Program hash or pipeline key
+		};
+
 		std::string version_prefix;
 		std::string root_path;
 		std::string pipeline_class_name;
@@ -418,6 +451,313 @@ namespace rsx
 
 		backend_storage& m_storage;
 
+		// Append-only pipeline archive (all records of this pipeline class and version)
+		fs::file m_file;
+
+		// Archive contents mapped at load time
+		fs::file_view m_view;
+
+		// Record offsets in the archive, indexed by type and key (includes queued records)
+		std::array<std::unordered_map<u64, u64>, record_type_count> m_index;
+
+		// Protects m_index and m_queue
+		shared_mutex m_mutex;
+
+		cond_variable m_cond;
+
+		// Records waiting for the writer thread
+		std::deque<std::vector<u8>> m_queue;
+
+		// Next record offset (archive size including queued records)
+		u64 m_end = 0;
+
+		bool m_stop = false;
+
+		// Writer thread, started with the first new record
+		std::unique_ptr<named_thread<std::function<void()>>> m_writer;
+
+		static std::vector<u8> make_record(u32 type, u64 key, const void* data, u32 size)
+		{
+			std::vector<u8> result(sizeof(record_header) + size);
+
+			record_header header{type, size, key};
+			std::memcpy(result.data(), &header, sizeof(header));
+
+			if (size)
+			{
+				std::memcpy(result.data() + sizeof(header), data, size);
+			}
+
+			return result;
+		}
+
+		void write_records()
+		{
+			while (true)
+			{
+				std::vector<u8> record;
+
+				{
+					std::lock_guard lock(m_mutex);
+
+					while (m_queue.empty() && !m_stop && !Emu.IsStopped())
+					{
+						m_cond.wait(m_mutex, 10000);
+					}
+
+					if (m_queue.empty())
+					{
+						break;
+					}
+
+					record = std::move(m_queue.front());
+					m_queue.pop_front();
+				}
+
+				if (m_file.write(record.data(), record.size()) != record.size())
+				{
+					LOG_ERROR(RSX, "shaders_cache: failed to write to the pipeline archive");
+				}
+			}
+		}
+
+		// Queue record for writing (m_mutex must be locked)
+		void push_record(u32 type, u64 key, const void* data, u32 size)
+		{
+			if (!m_index[type].emplace(key, m_end).second)
+			{
+				return;
+			}
+
+			m_queue.emplace_back(make_record(type, key, data, size));
+			m_end += m_queue.back().size();
+		}
+
+		// Reset archive contents
+		bool reset_archive()
+		{
+			m_view.close();
+
+			for (auto& index : m_index)
+			{
+				index.clear();
+			}
+
+			archive_header header{archive_magic, archive_version, 0};
+
+			if (!m_file.trunc(0) || m_file.write(&header, sizeof(header)) != sizeof(header))
+			{
+				m_file.close();
+				return false;
+			}
+
+			m_end = sizeof(header);
+			return true;
+		}
+
+		// Import loose files written by older versions (pipelines/<class>/<version>/*.bin and raw/*.vp, raw/*.fp)
+		void import_legacy(const std::string& directory_path)
+		{
+			u32 count = 0;
+
+			for (auto&& entry : fs::dir(directory_path))
+			{
+				if (entry.is_directory)
+				{
+					continue;
+				}
+
+				fs::file f(directory_path + "/" + entry.name);
+
+				pipeline_data data;
+
+				if (!f || f.size() != sizeof(pipeline_data) || f.read(&data, sizeof(data)) != sizeof(data))
+				{
+					continue;
+				}
+
+				fs::file vp_file(root_path + "/raw/" + fmt::format("%llX.vp", data.vertex_program_hash));
+				fs::file fp_file(root_path + "/raw/" + fmt::format("%llX.fp", data.fragment_program_hash));
+
+				if (!vp_file || !fp_file)
+				{
+					continue;
+				}
+
+				const auto vp_data = vp_file.to_vector<u8>();
+				const auto fp_data = fp_file.to_vector<u8>();
+
+				push_record(record_vp, data.vertex_program_hash, vp_data.data(), ::size32(vp_data));
+				push_record(record_fp, data.fragment_program_hash, fp_data.data(), ::size32(fp_data));
+				push_record(record_pipeline, get_pipeline_key(data), &data, sizeof(data));
+				count++;
+			}
+
+			for (auto& record : m_queue)
+			{
+				m_file.write(record.data(), record.size());
+			}
+
+			m_queue.clear();
+
+			if (count)
+			{
+				LOG_NOTICE(RSX, "shaders_cache: imported %u pipeline objects into the archive", count);
+			}
+		}
+
+		// Map the archive and index its records (returns offsets of pipeline records in build priority order)
+		std::vector<u64> scan_archive()
+		{
+			std::vector<u64> result;
+			std::unordered_map<u64, u64> use_order;
+
+			for (auto& index : m_index)
+			{
+				index.clear();
+			}
+
+			m_view = fs::file_view(m_file);
+
+			const u8* const base = m_view.data();
+			const u64 fsize = m_view.size();
+
+			archive_header header{};
+
+			if (m_view && fsize >= sizeof(archive_header))
+			{
+				std::memcpy(&header, base, sizeof(header));
+			}
+
+			if (header.magic != archive_magic || header.version != archive_version)
+			{
+				if (fsize)
+				{
+					LOG_ERROR(RSX, "shaders_cache: unsupported pipeline archive, resetting");
+				}
+
+				reset_archive();
+				return result;
+			}
+
+			u64 pos = sizeof(archive_header);
+			u32 invalid = 0;
+
+			// Only headers are read here, record data is accessed through the mapping
+			while (pos + sizeof(record_header) <= fsize)
+			{
+				record_header rh;
+				std::memcpy(&rh, base + pos, sizeof(rh));
+
+				const u64 next = pos + sizeof(record_header) + rh.size;
+
+				if (!rh.type || rh.type >= record_type_count || next > fsize)
+				{
+					break;
+				}
+
+				if (!m_index[rh.type].emplace(rh.key, pos).second)
+				{
+					// Duplicate record
+				}
+				else if (rh.type == record_use)
+				{
+					use_order.emplace(rh.key, use_order.size());
+				}
+				else if (rh.type == record_pipeline)
+				{
+					if (rh.size == sizeof(pipeline_data))
+					{
+						result.push_back(pos);
+					}
+					else
+					{
+						invalid++;
+					}
+				}
+
+				pos = next;
+			}
+
+			if (pos != fsize)
+			{
+				// Appending after a broken record would make the rest of the archive unreadable
+				LOG_ERROR(RSX, "shaders_cache: truncated or damaged pipeline archive (0x%llx of 0x%llx bytes are valid)", pos, fsize);
+				m_view.close();
+
+				if (!m_file.trunc(pos) || !(m_view = fs::file_view(m_file)))
+				{
+					result.clear();
+					reset_archive();
+					return result;
+				}
+			}
+
+			if (invalid)
+			{
+				LOG_ERROR(RSX, "shaders_cache: %u cached pipeline objects are not binary compatible with the current shader cache", invalid);
+			}
+
+			if (!use_order.empty())
+			{
+				// Pipelines which were needed early in previous runs go first, in the order they were needed
+				std::stable_sort(result.begin(), result.end(), [&](u64 a, u64 b)
+				{
+					record_header ha, hb;
+					std::memcpy(&ha, m_view.data() + a, sizeof(ha));
+					std::memcpy(&hb, m_view.data() + b, sizeof(hb));
+
+					const auto fa = use_order.find(ha.key);
+					const auto fb = use_order.find(hb.key);
+					const u64 oa = fa == use_order.end() ? UINT64_MAX : fa->second;
+					const u64 ob = fb == use_order.end() ? UINT64_MAX : fb->second;
+					return oa < ob;
+				});
+			}
+
+			m_end = pos;
+			return result;
+		}
+
+		// Get record data from the mapped archive
+		std::pair<const u8*, u32> get_record(u32 type, u64 key) const
+		{
+			const auto found = m_index[type].find(key);
+
+			if (found == m_index[type].end() || found->second + sizeof(record_header) > m_view.size())
+			{
+				return {};
+			}
+
+			record_header rh;
+			std::memcpy(&rh, m_view.data() + found->second, sizeof(rh));
+			return {m_view.data() + found->second + sizeof(rh), rh.size};
+		}
+
+		static u64 get_pipeline_key(const pipeline_data& data)
+		{
+			u64 state_hash = 0;
+			state_hash ^= rpcs3::hash_base<u32>(data.vp_ctrl);
+			state_hash ^= rpcs3::hash_base<u32>(data.fp_ctrl);
+			state_hash ^= rpcs3::hash_base<u32>(data.vp_texture_dimensions);
+			state_hash ^= rpcs3::hash_base<u32>(data.fp_texture_dimensions);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_unnormalized_coords);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_height);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_pixel_layout);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_lighting_flags);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_shadow_textures);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_redirected_textures);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_alphakill_mask);
+			state_hash ^= rpcs3::hash_base<u64>(data.fp_zfunc_mask);
+
+			// Same components as the file name used by older versions
+			u64 key = data.vertex_program_hash;
+			key = key * 0x100000001b3 ^ data.fragment_program_hash;
+			key = key * 0x100000001b3 ^ data.pipeline_storage_hash;
+			key = key * 0x100000001b3 ^ state_hash;
+			return key;
+		}
+
 	public:
 
 		struct progress_dialog_helper
@@ -511,6 +851,30 @@ namespace rsx
 			}
 		}
 
+		~shaders_cache()
+		{
+			{
+				std::lock_guard lock(m_mutex);
+				m_stop = true;
+			}
+
+			m_cond.notify_all();
+
+			// Wait for the writer thread to finish
+			m_writer.reset();
+
+			if (m_file)
+			{
+				// Records queued after the writer thread exited
+				for (auto& record : m_queue)
+				{
+					m_file.write(record.data(), record.size());
+				}
+			}
+		}
+
+		using link_task_type = typename backend_storage::async_link_task_entry;
+
 		template <typename... Args>
 		void load(progress_dialog_helper* dlg, Args&& ...args)
 		{
@@ -519,37 +883,36 @@ namespace rsx
 				return;
 			}
 
-			std::string directory_path = root_path + "/pipelines/" + pipeline_class_name + "/" + version_prefix;
+			const std::string class_path = root_path + "/pipelines/" + pipeline_class_name;
 
-			if (!fs::is_dir(directory_path))
+			if (!fs::is_dir(class_path))
 			{
-				fs::create_path(directory_path);
-				fs::create_path(root_path + "/raw");
-
-				return;
+				fs::create_path(class_path);
 			}
 
-			fs::dir root = fs::dir(directory_path);
+			std::vector<u64> pipelines;
 
-			u32 entry_count = 0;
-			std::vector<fs::dir_entry> entries;
-			for (auto It = root.begin(); It != root.end(); ++It, entry_count++)
 			{
-				fs::dir_entry tmp = *It;
+				std::lock_guard lock(m_mutex);
 
-				if (tmp.name == "." || tmp.name == "..")
-					continue;
+				if (!m_file.open(class_path + "/" + version_prefix + ".pack", fs::read + fs::write + fs::create + fs::append))
+				{
+					LOG_ERROR(RSX, "shaders_cache: failed to open the pipeline archive in %s", class_path);
+					return;
+				}
 
-				entries.push_back(tmp);
-			}
+				if (m_file.size() < sizeof(archive_header) && reset_archive() && fs::is_dir(class_path + "/" + version_prefix))
+				{
+					import_legacy(class_path + "/" + version_prefix);
+				}
 
-			if ((entry_count = (u32)entries.size()) <= 2)
-				return;
+				pipelines = scan_archive();
+			}
 
-			root.rewind();
+			u32 entry_count = ::size32(pipelines);
 
-			// Invalid pipeline entries to be removed
-			std::vector<std::string> invalid_entries;
+			if (!entry_count)
+				return;
 
 			// Progress dialog
 			std::unique_ptr<progress_dialog_helper> fallback_dlg;
@@ -559,87 +922,118 @@ namespace rsx
 				dlg = fallback_dlg.get();
 			}
 
+			// Pipelines built before the title starts, the rest is left to the asynchronous shader compiler
+			u32 foreground_count = entry_count;
+
+			if (!g_cfg.video.disable_asynchronous_shader_compiler)
+			{
+				foreground_count = static_cast<u32>((u64{entry_count} * g_cfg.video.shader_preloading_foreground + 99) / 100);
+			}
+
 			dlg->create();
-			dlg->set_limit(0, entry_count);
-			dlg->set_limit(1, entry_count);
-			dlg->update_msg(0, 0, entry_count);
-			dlg->update_msg(1, 0, entry_count);
-
-			// Setup worker threads
-			unsigned nb_threads = std::thread::hardware_concurrency();
-			std::vector<std::thread> worker_threads(nb_threads);
-
-			// Preload everything needed to compile the shaders
-			// Can probably be parallelized too, but since it's mostly reading files it's probably not worth it
-			std::vector<std::tuple<pipeline_storage_type, RSXVertexProgram, RSXFragmentProgram>> unpackeds;
+			dlg->set_limit(0, foreground_count);
+			dlg->set_limit(1, foreground_count);
+			dlg->update_msg(0, 0, foreground_count);
+			dlg->update_msg(1, 0, foreground_count);
+
+			// Unpacked pipelines are decompiled on this thread in priority order while the workers link them
+			std::vector<std::unique_ptr<link_task_type>> tasks(foreground_count);
+			atomic_t<u32> prepared(0);
+			atomic_t<u32> processed(0);
+
 			std::chrono::time_point<steady_clock> last_update;
 			u32 processed_since_last_update = 0;
+			u32 missing = 0;
 
-			for (u32 i = 0; (i < entry_count) && !Emu.IsStopped(); i++)
+			const auto unpack_entry = [&](u32 i, pipeline_data& data) -> bool
 			{
-				fs::dir_entry tmp = entries[i];
+				std::memcpy(&data, m_view.data() + pipelines[i] + sizeof(record_header), sizeof(data));
 
-				const auto filename = directory_path + "/" + tmp.name;
-				std::vector<u8> bytes;
-				fs::file f(filename);
-				if (f.size() != sizeof(pipeline_data))
+				if (!get_record(record_vp, data.vertex_program_hash).first || !get_record(record_fp, data.fragment_program_hash).first)
 				{
-					LOG_ERROR(RSX, "Cached pipeline object %s is not binary compatible with the current shader cache", tmp.name.c_str());
-					invalid_entries.push_back(filename);
-					continue;
+					missing++;
+					return false;
 				}
-				f.read<u8>(bytes, f.size());
-
-				auto unpacked = unpack(*(pipeline_data*)bytes.data());
-				m_storage.preload_programs(std::get<1>(unpacked), std::get<2>(unpacked));
-				unpackeds.push_back(unpacked);
 
-				// Only update the screen at about 10fps since updating it everytime slows down the process
-				std::chrono::time_point<steady_clock> now = std::chrono::steady_clock::now();
-				processed_since_last_update++;
-				if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - last_update) > 100ms) || (i == entry_count - 1))
-				{
-					dlg->update_msg(0, i + 1, entry_count);
-					dlg->inc_value(0, processed_since_last_update);
-					last_update = now;
-					processed_since_last_update = 0;
-				}
-			}
+				return true;
+			};
 
-			atomic_t<u32> processed(0);
-			std::function<void(u32)> shader_comp_worker = [&](u32 index)
+			const auto prepare_entries = [&]()
 			{
-				u32 pos;
-				while (((pos = processed++) < entry_count) && !Emu.IsStopped())
+				for (u32 i = 0; i < foreground_count; i++)
 				{
-					auto unpacked = unpackeds[pos];
-					m_storage.add_pipeline_entry(std::get<1>(unpacked), std::get<2>(unpacked), std::get<0>(unpacked), std::forward<Args>(args)...);
+					pipeline_data data;
+
+					if (!Emu.IsStopped() && unpack_entry(i, data))
+					{
+						auto unpacked = unpack(data);
+						tasks[i] = m_storage.prepare_pipeline_entry(std::get<1>(unpacked), std::get<2>(unpacked), std::get<0>(unpacked));
+					}
+
+					prepared = i + 1;
+
+					// Only update the screen at about 10fps since updating it everytime slows down the process
+					std::chrono::time_point<steady_clock> now = std::chrono::steady_clock::now();
+					processed_since_last_update++;
+					if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - last_update) > 100ms) || (i == foreground_count - 1))
+					{
+						dlg->update_msg(0, i + 1, foreground_count);
+						dlg->inc_value(0, processed_since_last_update);
+						last_update = now;
+						processed_since_last_update = 0;
+					}
 				}
 			};
 
 			if (g_cfg.video.renderer == video_renderer::vulkan)
 			{
-				// Start workers
-				for (u32 i = 0; i < nb_threads; i++)
+				u32 nb_threads = g_cfg.video.shader_preloading_threads;
+
+				if (!nb_threads)
 				{
-					worker_threads[i] = std::thread(shader_comp_worker, i);
+					nb_threads = std::thread::hardware_concurrency();
 				}
 
+				// Link workers follow the decompiler, waiting for each entry to be prepared
+				std::vector<std::thread> worker_threads(nb_threads);
+
+				for (auto& worker_thread : worker_threads)
+				{
+					worker_thread = std::thread([&]()
+					{
+						u32 pos;
+						while ((pos = processed++) < foreground_count)
+						{
+							while (prepared <= pos)
+							{
+								std::this_thread::sleep_for(1ms);
+							}
+
+							if (tasks[pos] && !Emu.IsStopped())
+							{
+								m_storage.link_pipeline(*tasks[pos], std::forward<Args>(args)...);
+							}
+						}
+					});
+				}
+
+				prepare_entries();
+
 				// Wait for the workers to finish their task while updating UI
 				u32 current_progress = 0;
 				u32 last_update_progress = 0;
 
-				while ((current_progress < entry_count) && !Emu.IsStopped())
+				while ((current_progress < foreground_count) && !Emu.IsStopped())
 				{
 					std::this_thread::sleep_for(100ms); // Around 10fps should be good enough
 
-					current_progress = std::min(processed.load(), entry_count);
+					current_progress = std::min(processed.load(), foreground_count);
 					processed_since_last_update = current_progress - last_update_progress;
 					last_update_progress = current_progress;
 
 					if (processed_since_last_update > 0)
 					{
-						dlg->update_msg(1, current_progress, entry_count);
+						dlg->update_msg(1, current_progress, foreground_count);
 						dlg->inc_value(1, processed_since_last_update);
 					}
 				}
@@ -650,18 +1044,23 @@ namespace rsx
 			}
 			else
 			{
-				u32 pos;
-				while (((pos = processed++) < entry_count) && !Emu.IsStopped())
+				prepare_entries();
+
+				processed_since_last_update = 0;
+
+				for (u32 pos = 0; (pos < foreground_count) && !Emu.IsStopped(); pos++)
 				{
-					auto unpacked = unpackeds[pos];
-					m_storage.add_pipeline_entry(std::get<1>(unpacked), std::get<2>(unpacked), std::get<0>(unpacked), std::forward<Args>(args)...);
+					if (tasks[pos])
+					{
+						m_storage.link_pipeline(*tasks[pos], std::forward<Args>(args)...);
+					}
 
 					// Update screen at about 10fps
 					std::chrono::time_point<steady_clock> now = std::chrono::steady_clock::now();
 					processed_since_last_update++;
-					if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - last_update) > 100ms) || (pos == entry_count - 1))
+					if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - last_update) > 100ms) || (pos == foreground_count - 1))
 					{
-						dlg->update_msg(1, pos + 1, entry_count);
+						dlg->update_msg(1, pos + 1, foreground_count);
 						dlg->inc_value(1, processed_since_last_update);
 						last_update = now;
 						processed_since_last_update = 0;
@@ -669,16 +1068,31 @@ namespace rsx
 				}
 			}
 
-			if (!invalid_entries.empty())
+			// Queue the remaining pipelines for the asynchronous shader compiler (programs are copied)
+			for (u32 i = foreground_count; (i < entry_count) && !Emu.IsStopped(); i++)
 			{
-				for (const auto &filename : invalid_entries)
+				pipeline_data data;
+
+				if (unpack_entry(i, data))
 				{
-					fs::remove_file(filename);
+					auto unpacked = unpack(data);
+					m_storage.queue_pipeline_entry(std::get<1>(unpacked), std::get<2>(unpacked), std::get<0>(unpacked));
 				}
+			}
 
-				LOG_NOTICE(RSX, "shader cache: %d entries were marked as invalid and removed", invalid_entries.size());
+			if (missing)
+			{
+				LOG_ERROR(RSX, "shaders_cache: %u cached pipeline objects reference missing programs", missing);
 			}
 
+			if (foreground_count < entry_count)
+			{
+				LOG_NOTICE(RSX, "shaders_cache: %u of %u cached pipeline objects will be built in background", entry_count - foreground_count, entry_count);
+			}
+
+			// Programs were copied, the mapping is no longer needed
+			m_view.close();
+
 			dlg->refresh();
 			dlg->close();
 		}
@@ -697,45 +1111,49 @@ namespace rsx
 			}
 
 			pipeline_data data = pack(pipeline, vp, fp);
-			std::string fp_name = root_path + "/raw/" + fmt::format("%llX.fp", data.fragment_program_hash);
-			std::string vp_name = root_path + "/raw/" + fmt::format("%llX.vp", data.vertex_program_hash);
 
-			if (!fs::is_file(fp_name))
 			{
-				fs::file(fp_name, fs::rewrite).write(fp.addr, fp.ucode_length);
-			}
+				std::lock_guard lock(m_mutex);
 
-			if (!fs::is_file(vp_name))
-			{
-				fs::file(vp_name, fs::rewrite).write<u32>(vp.data);
-			}
+				if (!m_file || m_stop)
+				{
+					return;
+				}
 
-			u64 state_hash = 0;
-			state_hash ^= rpcs3::hash_base<u32>(data.vp_ctrl);
-			state_hash ^= rpcs3::hash_base<u32>(data.fp_ctrl);
-			state_hash ^= rpcs3::hash_base<u32>(data.vp_texture_dimensions);
-			state_hash ^= rpcs3::hash_base<u32>(data.fp_texture_dimensions);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_unnormalized_coords);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_height);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_pixel_layout);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_lighting_flags);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_shadow_textures);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_redirected_textures);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_alphakill_mask);
-			state_hash ^= rpcs3::hash_base<u64>(data.fp_zfunc_mask);
+				const u64 key = get_pipeline_key(data);
+
+				if (m_index[record_pipeline].count(key))
+				{
+					// The title needed this pipeline before it was built from the archive, build it earlier next time
+					push_record(record_use, key, nullptr, 0);
+				}
+				else
+				{
+					push_record(record_fp, data.fragment_program_hash, fp.addr, fp.ucode_length);
+					push_record(record_vp, data.vertex_program_hash, vp.data.data(), ::size32(vp.data) * sizeof(u32));
+					push_record(record_pipeline, key, &data, sizeof(data));
+				}
+
+				if (m_queue.empty())
+				{
+					return;
+				}
+
+				if (!m_writer)
+				{
+					m_writer = std::make_unique<named_thread<std::function<void()>>>("RSX Shader Cache Writer", [this]{ write_records(); });
+				}
+			}
 
-			std::string pipeline_file_name = fmt::format("%llX+%llX+%llX+%llX.bin", data.vertex_program_hash, data.fragment_program_hash, data.pipeline_storage_hash, state_hash);
-			std::string pipeline_path = root_path + "/pipelines/" + pipeline_class_name + "/" + version_prefix + "/" + pipeline_file_name;
-			fs::file(pipeline_path, fs::rewrite).write(&data, sizeof(pipeline_data));
+			m_cond.notify_one();
 		}
 
 		RSXVertexProgram load_vp_raw(u64 program_hash)
 		{
-			std::vector<u32> data;
-			std::string filename = fmt::format("%llX.vp", program_hash);
+			const auto record = get_record(record_vp, program_hash);
 
-			fs::file f(root_path + "/raw/" + filename);
-			f.read<u32>(data, f.size() / sizeof(u32));
+			std::vector<u32> data(record.second / sizeof(u32));
+			std::memcpy(data.data(), record.first, data.size() * sizeof(u32));
 
 			RSXVertexProgram vp = {};
 			vp.data = data;
@@ -746,11 +1164,9 @@ namespace rsx
 
 		RSXFragmentProgram load_fp_raw(u64 program_hash)
 		{
-			std::vector<u8> data;
-			std::string filename = fmt::format("%llX.fp", program_hash);
+			const auto record = get_record(record_fp, program_hash);
 
-			fs::file f(root_path + "/raw/" + filename);
-			f.read<u8>(data, f.size());
+			std::vector<u8> data(record.first, record.first + record.second);
 
 			RSXFragmentProgram fp = {};
 			fragment_program_data[program_hash] = data;
@@ -5,6 +5,7 @@
 #include "Emu/System.h"
 #include "rsx_utils.h"
 #include "rsx_decode.h"
+#include "Common/software_blit.h"
 #include "Emu/Cell/PPUCallback.h"
 #include "Emu/Cell/lv2/sys_rsx.h"
 #include "Capture/rsx_capture.h"
@@ -56,6 +57,7 @@ namespace rsx
 		void set_reference(thread* rsx, u32 _reg, u32 arg)
 		{
 			rsx->sync();
+			rsx->write_barrier(0, UINT32_MAX);
 			rsx->ctrl->ref.exchange(arg);
 		}
 
@@ -108,6 +110,7 @@ namespace rsx
 		void semaphore_release(thread* rsx, u32 _reg, u32 arg)
 		{
 			rsx->sync();
+			rsx->write_barrier(0, UINT32_MAX);
 			rsx->sync_point_request = true;
 			const u32 addr = get_address(method_registers.semaphore_offset_406e(), method_registers.semaphore_context_dma_406e());
 
@@ -196,6 +199,7 @@ namespace rsx
 				//
 			}
 
+			rsx->write_barrier(0, UINT32_MAX);
 			auto& sema = vm::_ref<RsxSemaphore>(get_address(offset, method_registers.semaphore_context_dma_4097()));
 			sema.val = arg;
 			sema.pad = 0;
@@ -212,6 +216,7 @@ namespace rsx
 			}
 
 			rsx->sync();
+			rsx->write_barrier(0, UINT32_MAX);
 			u32 val = (arg & 0xff00ff00) | ((arg & 0xff) << 16) | ((arg >> 16) & 0xff);
 			auto& sema = vm::_ref<RsxSemaphore>(get_address(offset, method_registers.semaphore_context_dma_4097()));
 			sema.val = val;
@@ -786,6 +791,7 @@ namespace rsx
 				const u16 y = method_registers.nv308a_y();
 				const u32 pixel_offset = (method_registers.blit_engine_output_pitch_nv3062() * y) + (x * write_len);
 				u32 address = get_address(method_registers.blit_engine_output_offset_nv3062() + pixel_offset + (index * write_len), method_registers.blit_engine_output_location_nv3062());
+				rsx->write_barrier(address, write_len);
 
 				switch (write_len)
 				{
@@ -910,7 +916,8 @@ namespace rsx
 			const tiled_region dst_region = rsx->get_tiled_address(dst_offset + out_offset, dst_dma & 0xf);
 
 			u8* pixels_src = src_region.tile ? src_region.ptr + src_region.base : src_region.ptr;
-			u8* pixels_dst = vm::_ptr<u8>(get_address(dst_offset + out_offset, dst_dma));
+			const u32 dst_address = get_address(dst_offset + out_offset, dst_dma);
+			u8* pixels_dst = vm::_ptr<u8>(dst_address);
 
 			const auto read_address = get_address(src_offset, src_dma);
 			rsx->read_barrier(read_address, in_pitch * (in_h - 1) + (in_w * in_bpp));
@@ -1024,77 +1031,54 @@ namespace rsx
 					return;
 			}
 
-			std::unique_ptr<u8[]> temp1, temp2, temp3, sw_temp;
+			const bool flip_x = scale_x < 0;
+			const bool flip_y = scale_y < 0;
 
-			if (scale_y < 0 || scale_x < 0)
-			{
-				temp1.reset(new u8[in_pitch * (in_h - 1) + (in_bpp * in_w)]);
+			const bool need_clip =
+				clip_w != in_w ||
+				clip_h != in_h ||
+				clip_x > 0 || clip_y > 0 ||
+				convert_w != out_w || convert_h != out_h;
 
-				const s32 stride_y = (scale_y < 0 ? -1 : 1) * in_pitch; 
+			const bool need_convert = out_bpp != in_bpp || std::abs(scale_x) != 1.0 || std::abs(scale_y) != 1.0;
 
-				for (u32 y = 0; y < in_h; ++y)
-				{
-					u8 *dst = temp1.get() + (in_pitch * y);
-					u8 *src = pixels_src + (y * stride_y);
+			software_blit_src cpu_src{};
+			cpu_src.pixels = pixels_src;
+			cpu_src.format = src_color_format;
+			cpu_src.width = in_w;
+			cpu_src.height = in_h;
+			cpu_src.slice_h = std::min<u32>(slice_h, in_h);
+			cpu_src.pitch = flip_y ? -s32{in_pitch} : s32{in_pitch};
+			cpu_src.flip_x = flip_x;
 
-					if (scale_x < 0)
-					{
-						if (in_bpp == 2)
-						{
-							rsx::memcpy_r<u16>(dst, src, in_w);
-						}
-						else
-						{
-							rsx::memcpy_r<u32>(dst, src, in_w);
-						}
-					}
-					else
-					{
-						std::memcpy(dst, src, in_bpp * in_w);
-					}
-				}
+			software_blit_dst cpu_dst{};
+			cpu_dst.format = dst_color_format;
+			cpu_dst.scaled_width = convert_w;
+			cpu_dst.scaled_height = convert_h;
 
-				pixels_src = temp1.get();
+			if (need_clip)
+			{
+				cpu_dst.clip_x = clip_x;
+				cpu_dst.clip_y = clip_y;
+				cpu_dst.clip_width = clip_w;
+				cpu_dst.clip_height = clip_h;
+			}
+			else
+			{
+				cpu_dst.clip_width = out_w;
+				cpu_dst.clip_height = out_h;
 			}
 
-			const AVPixelFormat in_format = (src_color_format == rsx::blit_engine::transfer_source_format::r5g6b5) ? AV_PIX_FMT_RGB565BE : AV_PIX_FMT_ARGB;
-			const AVPixelFormat out_format = (dst_color_format == rsx::blit_engine::transfer_destination_format::r5g6b5) ? AV_PIX_FMT_RGB565BE : AV_PIX_FMT_ARGB;
-
-			const bool need_clip =
-				clip_w != in_w ||
-				clip_h != in_h ||
-				clip_x > 0 || clip_y > 0 ||
-				convert_w != out_w || convert_h != out_h;
+			const bool interpolate = in_inter == blit_engine::transfer_interpolator::foh;
 
-			const bool need_convert = out_format != in_format || std::abs(scale_x) != 1.0 || std::abs(scale_y) != 1.0;
+			// Scratch memory of the CPU path, reused between transfers
+			thread_local blit_arena g_tls_blit_linear, g_tls_blit_swizzled;
 
 			if (method_registers.blit_engine_context_surface() != blit_engine::context_surface::swizzle2d)
 			{
-				if (need_convert || need_clip)
-				{
-					if (need_clip)
-					{
-						if (need_convert)
-						{
-							temp2.reset(new u8[out_pitch * (std::max(convert_h, (u32)clip_h) - 1) + (out_bpp * std::max(convert_w, (u32)clip_w))]);
-
-							convert_scale_image(temp2.get(), out_format, convert_w, convert_h, out_pitch,
-								pixels_src, in_format, in_w, in_h, in_pitch, slice_h, in_inter == blit_engine::transfer_interpolator::foh);
+				rsx->write_barrier(dst_address, out_pitch * (out_h - 1) + out_bpp * out_w);
 
-							clip_image(pixels_dst, temp2.get(), clip_x, clip_y, clip_w, clip_h, out_bpp, out_pitch, out_pitch);
-						}
-						else
-						{
-							clip_image(pixels_dst, pixels_src, clip_x, clip_y, clip_w, clip_h, out_bpp, in_pitch, out_pitch);
-						}
-					}
-					else
-					{
-						convert_scale_image(pixels_dst, out_format, out_w, out_h, out_pitch,
-							pixels_src, in_format, in_w, in_h, in_pitch, slice_h, in_inter == blit_engine::transfer_interpolator::foh);
-					}
-				}
-				else
+				if (!need_convert && !need_clip && !flip_x && !flip_y)
 				{
 					if (out_pitch != in_pitch || out_pitch != out_bpp * out_w)
 					{
@@ -1111,38 +1095,34 @@ namespace rsx
 						std::memmove(pixels_dst, pixels_src, out_pitch * out_h);
 					}
 				}
-			}
-			else
-			{
-				if (need_convert || need_clip)
+				else
 				{
-					if (need_clip)
-					{
-						if (need_convert)
-						{
-							temp2.reset(new u8[out_pitch * (std::max(convert_h, (u32)clip_h) - 1) + (out_bpp * std::max(convert_w, (u32)clip_w))]);
+					const u32 dst_size = out_pitch * (cpu_dst.clip_height - 1) + out_bpp * cpu_dst.clip_width;
 
-							convert_scale_image(temp2.get(), out_format, convert_w, convert_h, out_pitch,
-								pixels_src, in_format, in_w, in_h, in_pitch, slice_h, in_inter == blit_engine::transfer_interpolator::foh);
+					// Bounds of the source texels, in memory order
+					const u8* src_begin = pixels_src - (flip_y ? in_pitch * (in_h - 1) : 0) - (flip_x ? in_bpp * (in_w - 1) : 0);
+					const u8* src_end = src_begin + in_pitch * (in_h - 1) + in_bpp * in_w;
 
-							clip_image(temp3, temp2.get(), clip_x, clip_y, clip_w, clip_h, out_bpp, out_pitch, out_pitch);
-						}
-						else
-						{
-							clip_image(temp3, pixels_src, clip_x, clip_y, clip_w, clip_h, out_bpp, in_pitch, out_pitch);
-						}
+					cpu_dst.pitch = out_pitch;
+
+					if (pixels_dst < src_end && src_begin < pixels_dst + dst_size)
+					{
+						// Transfer within the same surface, render into scratch memory first
+						u8* temp = g_tls_blit_linear.get(dst_size);
+						cpu_dst.pixels = temp;
+						software_blit(cpu_src, cpu_dst, interpolate);
+
+						clip_image(pixels_dst, temp, 0, 0, cpu_dst.clip_width, cpu_dst.clip_height, out_bpp, out_pitch, out_pitch);
 					}
 					else
 					{
-						temp3.reset(new u8[out_pitch * (out_h - 1) + (out_bpp * out_w)]);
-
-						convert_scale_image(temp3.get(), out_format, out_w, out_h, out_pitch,
-							pixels_src, in_format, in_w, in_h, in_pitch, clip_h, in_inter == blit_engine::transfer_interpolator::foh);
+						cpu_dst.pixels = pixels_dst;
+						software_blit(cpu_src, cpu_dst, interpolate);
 					}
-
-					pixels_src = temp3.get();
 				}
-
+			}
+			else
+			{
 				// It looks like rsx may ignore the requested swizzle size and just always
 				// round up to nearest power of 2
 				/*u8 sw_width_log2 = method_registers.nv309e_sw_width_log2();
@@ -1159,46 +1139,47 @@ namespace rsx
 				u32 sw_width = next_pow2(out_w);
 				u32 sw_height = next_pow2(out_h);
 
-				temp3.reset(new u8[out_bpp * sw_width * sw_height]);
+				const u32 sw_pitch = out_bpp * sw_width;
+				const u32 sw_size = sw_pitch * sw_height;
 
-				u8* linear_pixels = pixels_src;
-				u8* swizzled_pixels = temp3.get();
+				rsx->write_barrier(dst_address, sw_size);
 
-				// Check and pad texture out if we are given non power of 2 output
-				if (sw_width != out_w || sw_height != out_h)
-				{
-					sw_temp.reset(new u8[out_bpp * sw_width * sw_height]);
+				const u8* linear_pixels = pixels_src;
+				u32 linear_pitch = in_pitch;
 
-					switch (out_bpp)
-					{
-					case 1:
-						pad_texture<u8>(linear_pixels, sw_temp.get(), out_w, out_h, sw_width, sw_height);
-						break;
-					case 2:
-						pad_texture<u16>(linear_pixels, sw_temp.get(), out_w, out_h, sw_width, sw_height);
-						break;
-					case 4:
-						pad_texture<u32>(linear_pixels, sw_temp.get(), out_w, out_h, sw_width, sw_height);
-						break;
-					}
+				if (need_convert || need_clip || flip_x || flip_y)
+				{
+					// Render straight into the (padded) linear image
+					u8* temp = g_tls_blit_linear.get(sw_size);
+					cpu_dst.pixels = temp;
+					cpu_dst.pitch = sw_pitch;
+					software_blit(cpu_src, cpu_dst, interpolate);
+
+					linear_pixels = temp;
+					linear_pitch = sw_pitch;
+				}
+				else if (sw_width != out_w || sw_height != out_h)
+				{
+					// Pad texture out if we are given non power of 2 output
+					u8* temp = g_tls_blit_linear.get(sw_size);
+					clip_image(temp, pixels_src, 0, 0, out_w, out_h, out_bpp, in_pitch, sw_pitch);
 
-					linear_pixels = sw_temp.get();
+					linear_pixels = temp;
+					linear_pitch = sw_pitch;
 				}
 
-				switch (out_bpp)
+				if (linear_pixels != pixels_src)
 				{
-				case 1:
-					convert_linear_swizzle<u8>(linear_pixels, swizzled_pixels, sw_width, sw_height, in_pitch, false);
-					break;
-				case 2:
-					convert_linear_swizzle<u16>(linear_pixels, swizzled_pixels, sw_width, sw_height, in_pitch, false);
-					break;
-				case 4:
-					convert_linear_swizzle<u32>(linear_pixels, swizzled_pixels, sw_width, sw_height, in_pitch, false);
-					break;
+					convert_linear_swizzle(linear_pixels, pixels_dst, sw_width, sw_height, linear_pitch, out_bpp, false);
 				}
+				else
+				{
+					// Source may overlap the destination
+					u8* swizzled_pixels = g_tls_blit_swizzled.get(sw_size);
+					convert_linear_swizzle(linear_pixels, swizzled_pixels, sw_width, sw_height, linear_pitch, out_bpp, false);
 
-				std::memcpy(pixels_dst, swizzled_pixels, out_bpp * sw_width * sw_height);
+					std::memcpy(pixels_dst, swizzled_pixels, sw_size);
+				}
 			}
 		}
 	}
@@ -1233,7 +1214,10 @@ namespace rsx
 			const auto read_address = get_address(src_offset, src_dma);
 			rsx->read_barrier(read_address, in_pitch * (line_count - 1) + line_length);
 
-			u8 *dst = (u8*)vm::base(get_address(dst_offset, dst_dma));
+			const auto write_address = get_address(dst_offset, dst_dma);
+			rsx->write_barrier(write_address, out_pitch * (line_count - 1) + line_length);
+
+			u8 *dst = (u8*)vm::base(write_address);
 			const u8 *src = (u8*)vm::base(read_address);
 
 			if (in_pitch == out_pitch && out_pitch == line_length)
@@ -4,6 +4,7 @@
 #include "RSXThread.h"
 #include "Emu/RSX/GCM.h"
 #include "Common/BufferUtils.h"
+#include "Common/host_job_pool.h"
 #include "Overlays/overlays.h"
 #include "Utilities/sysinfo.h"
 
@@ -288,6 +289,296 @@ namespace rsx
 		}
 	}
 
+	// Spread the low 16 bits to even bit positions
+	static inline u32 spread_bits_2d(u32 v)
+	{
+		v &= 0xffff;
+		v = (v | (v << 8)) & 0x00ff00ff;
+		v = (v | (v << 4)) & 0x0f0f0f0f;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	}
+
+	// Spread the low 10 bits to every third bit position
+	static inline u32 spread_bits_3d(u32 v)
+	{
+		v &= 0x3ff;
+		v = (v | (v << 16)) & 0x030000ff;
+		v = (v | (v << 8)) & 0x0300f00f;
+		v = (v | (v << 4)) & 0x030c30c3;
+		v = (v | (v << 2)) & 0x09249249;
+		return v;
+	}
+
+	// Texel offset in a 2D swizzled surface, bits of the larger dimension above the smaller one are not interleaved
+	struct swizzle_2d_layout
+	{
+		u32 log2;
+		u32 low_mask;
+
+		swizzle_2d_layout(u16 width, u16 height)
+			: log2(std::min(ceil_log2(width), ceil_log2(height)))
+			, low_mask((1u << log2) - 1)
+		{
+		}
+
+		u32 offset(u32 x, u32 y) const
+		{
+			return spread_bits_2d(x & low_mask) | spread_bits_2d(y & low_mask) << 1 | ((x | y) & ~low_mask) << log2;
+		}
+	};
+
+	// Minimal amount of data processed by a worker thread
+	constexpr u32 swizzle_min_part_size = 512 * 1024;
+
+	// a = [A0 A1 A2 A3], b = [B0 B1 B2 B3] -> lo = [A0 A1 B0 B1], hi = [A2 A3 B2 B3]
+	// Converts pairs of rows to 2x2 Morton groups and back, as the operation is its own inverse
+	template <u32 Size>
+	static inline void transpose_texel_pairs(const u8* a, const u8* b, u8* lo, u8* hi)
+	{
+		std::memcpy(lo, a, Size * 2);
+		std::memcpy(lo + Size * 2, b, Size * 2);
+		std::memcpy(hi, a + Size * 2, Size * 2);
+		std::memcpy(hi + Size * 2, b + Size * 2, Size * 2);
+	}
+
+	template <>
+	inline void transpose_texel_pairs<2>(const u8* a, const u8* b, u8* lo, u8* hi)
+	{
+		const __m128i v = _mm_unpacklo_epi32(_mm_loadl_epi64((const __m128i*)a), _mm_loadl_epi64((const __m128i*)b));
+		_mm_storel_epi64((__m128i*)lo, v);
+		_mm_storel_epi64((__m128i*)hi, _mm_unpackhi_epi64(v, v));
+	}
+
+	template <>
+	inline void transpose_texel_pairs<4>(const u8* a, const u8* b, u8* lo, u8* hi)
+	{
+		const __m128i va = _mm_loadu_si128((const __m128i*)a);
+		const __m128i vb = _mm_loadu_si128((const __m128i*)b);
+		_mm_storeu_si128((__m128i*)lo, _mm_unpacklo_epi64(va, vb));
+		_mm_storeu_si128((__m128i*)hi, _mm_unpackhi_epi64(va, vb));
+	}
+
+	// Convert rows [y_begin, y_end) of a 2D surface in 4x4 tiles, the remaining texels one by one
+	template <u32 Size, bool Deswizzle>
+	static void convert_linear_swizzle_rows(const u8* src, u8* dst, u16 width, u16 height, u32 pitch, const swizzle_2d_layout& layout, u32 y_begin, u32 y_end)
+	{
+		auto copy_texel = [&](u32 x, u32 y)
+		{
+			const u32 offset = layout.offset(x, y) * Size;
+			const u32 linear = y * pitch + x * Size;
+
+			if constexpr (Deswizzle)
+			{
+				std::memcpy(dst + linear, src + offset, Size);
+			}
+			else
+			{
+				std::memcpy(dst + offset, src + linear, Size);
+			}
+		};
+
+		// A 4x4 tile is contiguous in the swizzled surface if both dimensions are at least 4
+		const u32 tiled_width = layout.log2 >= 2 ? width & ~3 : 0;
+
+		u32 y = y_begin;
+
+		for (; tiled_width && y + 4 <= y_end; y += 4)
+		{
+			for (u32 x = 0; x < tiled_width; x += 4)
+			{
+				const u32 offset = layout.offset(x, y) * Size;
+				const u32 linear = y * pitch + x * Size;
+
+				if constexpr (Deswizzle)
+				{
+					const u8* in = src + offset;
+					u8* out = dst + linear;
+					transpose_texel_pairs<Size>(in, in + Size * 4, out, out + pitch);
+					transpose_texel_pairs<Size>(in + Size * 8, in + Size * 12, out + pitch * 2, out + pitch * 3);
+				}
+				else
+				{
+					const u8* in = src + linear;
+					u8* out = dst + offset;
+					transpose_texel_pairs<Size>(in, in + pitch, out, out + Size * 4);
+					transpose_texel_pairs<Size>(in + pitch * 2, in + pitch * 3, out + Size * 8, out + Size * 12);
+				}
+			}
+
+			for (u32 row = y; row < y + 4; row++)
+			{
+				for (u32 x = tiled_width; x < width; x++)
+				{
+					copy_texel(x, row);
+				}
+			}
+		}
+
+		for (; y < y_end; y++)
+		{
+			for (u32 x = 0; x < width; x++)
+			{
+				copy_texel(x, y);
+			}
+		}
+	}
+
+	template <u32 Size>
+	static void convert_linear_swizzle_impl(const void* input_pixels, void* output_pixels, u16 width, u16 height, u32 pitch, bool input_is_swizzled)
+	{
+		const swizzle_2d_layout layout(width, height);
+		const auto src = static_cast<const u8*>(input_pixels);
+		const auto dst = static_cast<u8*>(output_pixels);
+
+		// Bands of 4 rows are processed independently
+		const u32 bands = (height + 3) / 4;
+		const u32 min_part = std::max<u32>(swizzle_min_part_size / std::max<u32>(width * Size * 4, 1), 1);
+
+		auto process = [&](u32 begin, u32 end)
+		{
+			const u32 y_begin = begin * 4;
+			const u32 y_end = std::min<u32>(end * 4, height);
+
+			if (input_is_swizzled)
+			{
+				convert_linear_swizzle_rows<Size, true>(src, dst, width, height, pitch, layout, y_begin, y_end);
+			}
+			else
+			{
+				convert_linear_swizzle_rows<Size, false>(src, dst, width, height, pitch, layout, y_begin, y_end);
+			}
+		};
+
+		if (bands < min_part * 2)
+		{
+			process(0, bands);
+			return;
+		}
+
+		get_host_job_pool()->parallel_for(bands, min_part, process);
+	}
+
+	void convert_linear_swizzle(const void* input_pixels, void* output_pixels, u16 width, u16 height, u32 pitch, u32 texel_size, bool input_is_swizzled)
+	{
+		switch (texel_size)
+		{
+		case 1: return convert_linear_swizzle_impl<1>(input_pixels, output_pixels, width, height, pitch, input_is_swizzled);
+		case 2: return convert_linear_swizzle_impl<2>(input_pixels, output_pixels, width, height, pitch, input_is_swizzled);
+		case 4: return convert_linear_swizzle_impl<4>(input_pixels, output_pixels, width, height, pitch, input_is_swizzled);
+		case 8: return convert_linear_swizzle_impl<8>(input_pixels, output_pixels, width, height, pitch, input_is_swizzled);
+		case 16: return convert_linear_swizzle_impl<16>(input_pixels, output_pixels, width, height, pitch, input_is_swizzled);
+		default: fmt::throw_exception("Unsupported texel size %u" HERE, texel_size);
+		}
+	}
+
+	// Deswizzle slices [z_begin, z_end) of a 3D surface in 4x2x2 tiles, the remaining texels one by one
+	template <u32 Size>
+	static void convert_linear_swizzle_3d_slices(const u8* src, u8* dst, u16 width, u16 height, u32 z_begin, u32 z_end, bool tiled)
+	{
+		const u32 pitch = width * Size;
+		const u32 slice = pitch * height;
+		const u32 tiled_width = tiled ? width & ~3 : 0;
+		const u32 tiled_height = tiled ? height & ~1 : 0;
+
+		auto copy_row = [&](u32 x_begin, u32 y, u32 z)
+		{
+			u8* out = dst + z * slice + y * pitch;
+
+			for (u32 x = x_begin; x < width; x++)
+			{
+				std::memcpy(out + x * Size, src + calculate_z_index(x, y, z) * Size, Size);
+			}
+		};
+
+		u32 z = z_begin;
+
+		for (; tiled && z + 2 <= z_end; z += 2)
+		{
+			const u32 z_bits = spread_bits_3d(z) << 2;
+
+			for (u32 y = 0; y < tiled_height; y += 2)
+			{
+				const u32 yz_bits = z_bits | spread_bits_3d(y) << 1;
+				u8* out = dst + z * slice + y * pitch;
+
+				for (u32 x = 0; x < tiled_width; x += 4)
+				{
+					const u8* in = src + (yz_bits | spread_bits_3d(x)) * Size;
+					u8* row = out + x * Size;
+					transpose_texel_pairs<Size>(in, in + Size * 8, row, row + pitch);
+					transpose_texel_pairs<Size>(in + Size * 4, in + Size * 12, row + slice, row + slice + pitch);
+				}
+
+				copy_row(tiled_width, y, z);
+				copy_row(tiled_width, y + 1, z);
+				copy_row(tiled_width, y, z + 1);
+				copy_row(tiled_width, y + 1, z + 1);
+			}
+
+			for (u32 y = tiled_height; y < height; y++)
+			{
+				copy_row(0, y, z);
+				copy_row(0, y, z + 1);
+			}
+		}
+
+		for (; z < z_end; z++)
+		{
+			for (u32 y = 0; y < height; y++)
+			{
+				copy_row(0, y, z);
+			}
+		}
+	}
+
+	template <u32 Size>
+	static void convert_linear_swizzle_3d_impl(const void* input_pixels, void* output_pixels, u16 width, u16 height, u16 depth)
+	{
+		const auto src = static_cast<const u8*>(input_pixels);
+		const auto dst = static_cast<u8*>(output_pixels);
+
+		// Tile offsets are computed for up to 10 bits per coordinate
+		const bool tiled = width <= 1024 && height <= 1024 && depth <= 1024;
+
+		// Pairs of slices are processed independently
+		const u32 pairs = (depth + 1) / 2;
+		const u32 min_part = std::max<u32>(swizzle_min_part_size / std::max<u32>(width * height * Size * 2, 1), 1);
+
+		auto process = [&](u32 begin, u32 end)
+		{
+			convert_linear_swizzle_3d_slices<Size>(src, dst, width, height, begin * 2, std::min<u32>(end * 2, depth), tiled);
+		};
+
+		if (pairs < min_part * 2)
+		{
+			process(0, pairs);
+			return;
+		}
+
+		get_host_job_pool()->parallel_for(pairs, min_part, process);
+	}
+
+	void convert_linear_swizzle_3d(const void* input_pixels, void* output_pixels, u16 width, u16 height, u16 depth, u32 texel_size)
+	{
+		if (depth == 1)
+		{
+			convert_linear_swizzle(input_pixels, output_pixels, width, height, width * texel_size, texel_size, true);
+			return;
+		}
+
+		switch (texel_size)
+		{
+		case 1: return convert_linear_swizzle_3d_impl<1>(input_pixels, output_pixels, width, height, depth);
+		case 2: return convert_linear_swizzle_3d_impl<2>(input_pixels, output_pixels, width, height, depth);
+		case 4: return convert_linear_swizzle_3d_impl<4>(input_pixels, output_pixels, width, height, depth);
+		case 8: return convert_linear_swizzle_3d_impl<8>(input_pixels, output_pixels, width, height, depth);
+		case 16: return convert_linear_swizzle_3d_impl<16>(input_pixels, output_pixels, width, height, depth);
+		default: fmt::throw_exception("Unsupported texel size %u" HERE, texel_size);
+		}
+	}
+
 	void convert_le_f32_to_be_d24(void *dst, void *src, u32 row_length_in_texels, u32 num_rows)
 	{
 		const u32 num_pixels = row_length_in_texels * num_rows;
@@ -18,6 +18,7 @@
 #include "Emu/IdManager.h"
 #include "Emu/RSX/GSRender.h"
 #include "Emu/RSX/Capture/rsx_replay.h"
+#include "Emu/RSX/Capture/rsx_capture_stream.h"
 
 #include "Loader/PSF.h"
 #include "Loader/ELF.h"
@@ -474,21 +475,44 @@ bool Emulator::BootRsxCapture(const std::string& path)
 	if (!fs::is_file(path))
 		return false;
 
-	std::fstream f(path, std::ios::in | std::ios::binary);
+	fs::file file(path);
+	u32 header[2]{};
 
-	cereal::BinaryInputArchive archive(f);
-	std::unique_ptr<rsx::frame_capture_data> frame = std::make_unique<rsx::frame_capture_data>();
-	archive(*frame);
-
-	if (frame->magic != rsx::FRAME_CAPTURE_MAGIC)
+	if (!file || file.read(header, sizeof(header)) != sizeof(header) || header[0] != rsx::FRAME_CAPTURE_MAGIC)
 	{
 		LOG_ERROR(LOADER, "Invalid rsx capture file!");
 		return false;
 	}
 
-	if (frame->version != rsx::FRAME_CAPTURE_VERSION)
+	std::unique_ptr<rsx::frame_capture_data> frame;
+	std::unique_ptr<rsx::capture_stream_reader> stream;
+
+	if (header[1] == rsx::FRAME_CAPTURE_STREAM_VERSION)
+	{
+		// Multi-frame capture, frames are loaded by the replay thread
+		stream = std::make_unique<rsx::capture_stream_reader>(std::move(file));
+
+		if (!stream->frame_count())
+		{
+			LOG_ERROR(LOADER, "Invalid rsx capture file!");
+			return false;
+		}
+
+		LOG_NOTICE(LOADER, "Rsx capture: %u frames", stream->frame_count());
+	}
+	else if (header[1] == rsx::FRAME_CAPTURE_VERSION)
 	{
-		LOG_ERROR(LOADER, "Rsx capture file version not supported! Expected %d, found %d", rsx::FRAME_CAPTURE_VERSION, frame->version);
+		file.close();
+
+		std::fstream f(path, std::ios::in | std::ios::binary);
+
+		cereal::BinaryInputArchive archive(f);
+		frame = std::make_unique<rsx::frame_capture_data>();
+		archive(*frame);
+	}
+	else
+	{
+		LOG_ERROR(LOADER, "Rsx capture file version not supported! Expected %d, found %d", rsx::FRAME_CAPTURE_STREAM_VERSION, header[1]);
 		return false;
 	}
 
@@ -510,7 +534,14 @@ bool Emulator::BootRsxCapture(const std::string& path)
 	GetCallbacks().on_run();
 	m_state = system_state::running;
 
-	fxm::make<named_thread<rsx::rsx_replay_thread>>("RSX Replay", std::move(frame));
+	if (stream)
+	{
+		fxm::make<named_thread<rsx::rsx_replay_thread>>("RSX Replay", std::move(stream));
+	}
+	else
+	{
+		fxm::make<named_thread<rsx::rsx_replay_thread>>("RSX Replay", std::move(frame));
+	}
 
 	return true;
 }
@@ -844,6 +875,8 @@ void Emulator::Load(bool add_only, bool force_global_config)
 
 		LOG_NOTICE(LOADER, "Used configuration:\n%s\n", g_cfg.to_string());
 
+		logs::set_deferred(g_cfg.misc.deferred_log);
+
 		// Set RTM usage
 		g_use_rtm = utils::has_rtm() && ((utils::has_mpx() && g_cfg.core.enable_TSX == tsx_usage::enabled) || g_cfg.core.enable_TSX == tsx_usage::forced);
 		if (g_use_rtm && !utils::has_mpx())
@@ -377,6 +377,10 @@ struct cfg_root : cfg::node
 		cfg::_bool spu_accurate_putlluc{this, "Accurate PUTLLUC", false};
 		cfg::_bool spu_verification{this, "SPU Verification", true}; // Should be enabled
 		cfg::_bool spu_cache{this, "SPU Cache", true};
+		cfg::_bool spu_profiling{this, "SPU Profiling", false}; // Count SPU function executions (LLVM), used to optimize hot functions in the next run
+		cfg::_int<0, 16> spu_llvm_workers{this, "SPU LLVM Background Workers", 0}; // Interpret new SPU code while it's being compiled in background (0 = disabled)
+		cfg::_bool spu_llvm_workers_precise{this, "SPU Background Precise Interpreter", false}; // Use the precise interpreter for SPU code waiting for background compilation
+		cfg::_bool spu_async_mfc{this, "SPU Asynchronous MFC", false}; // Process large GET/PUT commands on a DMA thread per SPU thread group
 		cfg::_enum<tsx_usage> enable_TSX{this, "Enable TSX", tsx_usage::enabled}; // Enable TSX. Forcing this on Haswell/Broadwell CPUs should be used carefully
 		cfg::_bool spu_accurate_xfloat{this, "Accurate xfloat", false};
 		cfg::_bool spu_approx_xfloat{this, "Approximate xfloat", true};
@@ -413,6 +417,7 @@ struct cfg_root : cfg::node
 
 		cfg::_bool limit_cache_size{this, "Limit disk cache size", false};
 		cfg::_int<0, 10240> cache_max_size{this, "Disk cache maximum size (MB)", 5120};
+		cfg::_int<1, 16> aio_threads{this, "cellFsAio Worker Threads", 2};
 
 	} vfs{this};
 
@@ -455,6 +460,10 @@ struct cfg_root : cfg::node
 		cfg::_int<0, 16> anisotropic_level_override{this, "Anisotropic Filter Override", 0};
 		cfg::_int<1, 1024> min_scalable_dimension{this, "Minimum Scalable Dimension", 16};
 		cfg::_int<0, 30000000> driver_recovery_timeout{this, "Driver Recovery Timeout", 1000000};
+		cfg::_int<0, 64> shader_preloading_threads{this, "Shader Preloading Threads", 0}; // Threads linking cached pipelines at boot (0 = all hardware threads)
+		cfg::_int<0, 100> shader_preloading_foreground{this, "Shader Preloading Foreground Percent", 100}; // Part of the cache built before the game starts, the rest is built by the async shader compiler
+		cfg::_int<0, 16> host_worker_threads{this, "Host Worker Threads", 0}; // Threads for CPU-side texture and blit processing (0 = automatic)
+		cfg::_int<1, 3600> capture_frame_count{this, "Frame Capture Count", 1}; // Consecutive frames stored by an RSX capture
 
 		struct node_d3d12 : cfg::node
 		{
@@ -578,6 +587,7 @@ struct cfg_root : cfg::node
 		cfg::_bool show_trophy_popups{ this, "Show trophy popups", true};
 		cfg::_bool show_shader_compilation_hint{ this, "Show shader compilation hint", true };
 		cfg::_bool use_native_interface{ this, "Use native user interface", true };
+		cfg::_bool deferred_log{ this, "Deferred log formatting", false }; // Format log messages on the log writer thread when possible
 		cfg::_int<1, 65535> gdb_server_port{this, "Port", 2345};
 
 	} misc{this};
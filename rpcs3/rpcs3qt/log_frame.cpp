@@ -81,6 +81,11 @@ struct gui_listener : logs::listener
 		}
 	}
 
+	bool is_enabled(logs::level sev) const override
+	{
+		return sev <= enabled;
+	}
+
 	void pop()
 	{
 		pending.pop_front();